@@ -6,21 +6,9 @@
 
 
 
-[[maybe_unused]] static const char* kEngineNames[] = {
-    "Sine",              // 0
-    "Triangle",          // 1
-    "Square",            // 2
-    "Saw",               // 3
-    "SuperSaw",          // 4
-    "Virtual Analog",    // 5
-    "FM/Phase Mod",      // 6
-    "Formant",           // 7
-    "Additive",          // 8
-    "Chord",             // 9
-    "String/Resonator",  // 10
-    "PWM"                // 11
-};
-static constexpr int kNumEngines = sizeof(kEngineNames) / sizeof(kEngineNames[0]);
+// Engine names and count come from the compile-time registry
+#include "engines/engine_registry.h"
+static constexpr int kNumEngines = SynthEngines::kCount;
 
 
 enum Parameters {
@@ -39,10 +27,34 @@ enum Parameters {
     kParamLfoWave,    // Peaks LFO waveform
     kParamLfoVar,     // Peaks LFO waveform variation
     kParamReverb,     // Basic reverb amount
-    kParamDelay,      // Delay amount
+    kParamDelay,      // Delay wet/dry mix
     kParamChorus,     // Chorus amount
     kParamFilterCutoff, // Moog filter cutoff
     kParamFilterResonance, // Moog filter resonance
     kParamFilterWet, // Moog filter wet/dry
+    // Deadline monitor
+    kParamNearMissThreshold, // Block load counted as a near-miss
+    kParamCpuLoadP50,   // Output: median block load (fraction of deadline)
+    kParamCpuLoadP99,   // Output: 99th percentile block load
+    kParamCpuLoadMax,   // Output: recent peak block load
+    kParamNearMisses,   // Output: blocks at or above the near-miss threshold
+    kParamLockedMemory, // Output: audio-thread memory locked by activate() (KiB)
+    kParamQuality,      // Oversampling of engine saturation and the Moog filter: 1x/2x/4x/8x
+    // Modulation matrix: four routes of source, destination, amount
+    kParamMod1Source, kParamMod1Dest, kParamMod1Amount,
+    kParamMod2Source, kParamMod2Dest, kParamMod2Amount,
+    kParamMod3Source, kParamMod3Dest, kParamMod3Amount,
+    kParamMod4Source, kParamMod4Dest, kParamMod4Amount,
+    kParamLfoSync,      // LFO tempo division (0 = free running at LFO Freq)
+    kParamLimiter,      // Output true-peak limiter on/off
+    kParamLimiterCeiling, // Limiter ceiling (dBTP)
+    kParamDelayTime,    // Delay time (ms), glides when changed
+    kParamDelayFeedback, // Delay feedback from the last tap
+    kParamDelayTaps,    // Delay taps, spread evenly up to Delay Time
+    kParamDelayPingPong, // Delay cross-feedback between channels
+    kParamReverbMode,   // 0 = algorithmic (combs), 1 = convolution with the loaded IR
+    kParamUnison,       // Stacked, detuned copies of the engine (1-8)
+    kParamUnisonDetune, // Pitch and pan spread of the unison copies
+    kParamEco,          // Render engine and effects at host/2 or host/4, from the next activation
     kParamCount
 };
@@ -4,43 +4,27 @@
 
 
 
-// --- Improved Delay Effect: Longer, lowpass feedback, better wet/dry ---
-struct ImprovedDelay {
-    std::vector<float> buf;
-    size_t idx = 0;
-    float lastOut = 0.0f;
-    float lp = 0.0f;
-    ImprovedDelay() : buf(48000, 0.0f) {} // up to 1s at 48kHz
-    void reset() { std::fill(buf.begin(), buf.end(), 0.0f); idx = 0; lp = 0.0f; }
-    float process(float in, float amount, float sampleRate) {
-        // Delay time: 40ms to 1s
-        float maxDelay = 1.0f * sampleRate;
-        float minDelay = 0.04f * sampleRate;
-        size_t delaySamps = static_cast<size_t>(minDelay + (maxDelay - minDelay) * amount);
-        size_t readIdx = (idx + buf.size() - delaySamps) % buf.size();
-        float delayed = buf[readIdx];
-        // Simple lowpass in feedback
-        lp = 0.7f * lp + 0.3f * delayed;
-        buf[idx] = in + lp * (0.45f + 0.45f * amount); // more feedback at higher amount
-        idx = (idx + 1) % buf.size();
-        // Wet/dry
-        return in * (1.0f - amount) + delayed * amount;
-    }
-};
-
 // --- Improved Chorus Effect: Multi-voice, LFO smoothing, interpolation ---
 #include <array>
+#include <cmath>
 struct ImprovedChorus {
     static constexpr int voices = 3;
     std::vector<float> buf;
     size_t idx = 0;
     std::array<float, voices> phase{{0.0f, 2.1f, 4.2f}};
-    ImprovedChorus() : buf(5120, 0.0f) {} // up to ~107ms, with margin
+    static constexpr size_t kLength = 5120; // up to ~107ms at 48kHz, with margin
+    float rateScale = 1.0f; // depth and line length are set in samples at 48kHz
+    // Allocates the line; called from activate(), never from the audio thread
+    void prepare(float sampleRate) {
+        rateScale = sampleRate / 48000.0f;
+        buf.assign(size_t(std::ceil(float(kLength) * rateScale)), 0.0f);
+        idx = 0; phase = {0.0f, 2.1f, 4.2f};
+    }
     void reset() { std::fill(buf.begin(), buf.end(), 0.0f); idx = 0; phase = {0.0f, 2.1f, 4.2f}; }
     float process(float in, float amount, float sampleRate) {
         float out = 0.0f;
         float lfoRate = 0.25f + 1.5f * amount;
-        float lfoDepth = 80.0f + 320.0f * amount; // 1.7–8ms
+        float lfoDepth = (80.0f + 320.0f * amount) * rateScale; // 1.7–8ms
         size_t bufsize = buf.size();
         for (int v = 0; v < voices; ++v) {
             phase[v] += lfoRate * (1.0f + 0.2f * v) * 2.0f * 3.14159f / sampleRate;
@@ -67,73 +51,123 @@ struct ImprovedChorus {
 
 // DistrhoPlugin5yn7h_.cpp
 #include "5yn7h_.hpp"
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <cmath>
-#include "engines/sine_engine.h"
-#include "engines/triangle_engine.h"
-#include "engines/square_engine.h"
-#include "engines/saw_engine.h"
-
 #include "engines/adsr_peaks.h"
 #include "engines/ad_peaks.h"
 #include "engines/lfo_peaks.h"
-#include "engines/supersaw_engine.h"
-#include "engines/faithful_virtual_analog_engine.h"
-#include "engines/fm_engine.h"
-#include "engines/formant_engine.h"
-#include "engines/additive_engine.h"
-#include "engines/chord_engine.h"
-
-
-#include "engines/string_engine.h"
-#include "engines/pwm_engine.h"
 
 #include "moog_filter.hpp"
+#include "engines/oversampler.h"
+#include "stage_profiler.hpp"
+#include "deadline_monitor.hpp"
+#include "param_store.hpp"
+#include "dsp_memory.hpp"
+#include "mod_matrix.hpp"
+#include "limiter.hpp"
+#include "stereo_delay.hpp"
+#include "convolution_reverb.hpp"
+#include "polyphase_upsampler.hpp"
+#include "telemetry.hpp"
 
 START_NAMESPACE_DISTRHO
 
+// LFO Sync choices: a length in quarter notes, or in bars of the host's meter
+struct LfoDivision { const char* name; double quarters; double bars; };
+static constexpr LfoDivision kLfoDivisions[] = {
+    { "Free", 0.0, 0.0 },
+    { "4 bars", 0.0, 4.0 }, { "2 bars", 0.0, 2.0 }, { "1 bar", 0.0, 1.0 },
+    { "1/2", 2.0, 0.0 }, { "1/4", 1.0, 0.0 }, { "1/4T", 2.0 / 3.0, 0.0 },
+    { "1/8", 0.5, 0.0 }, { "1/8T", 1.0 / 3.0, 0.0 },
+    { "1/16", 0.25, 0.0 }, { "1/16T", 1.0 / 6.0, 0.0 }, { "1/32", 0.125, 0.0 },
+};
+static constexpr int kNumLfoDivisions = int(sizeof(kLfoDivisions) / sizeof(kLfoDivisions[0]));
+
 class Plugin5yn7h_ : public Plugin {
+    // Members are ordered hot to cold: everything run() touches every block
+    // comes first and sits together, host-thread and diagnostic state last.
+    static constexpr uint32_t kMaxBlock = 64;
+    // Scratch for the staged chain in run()
+    alignas(64) float blockL[kMaxBlock];
+    alignas(64) float blockR[kMaxBlock];
+    // Audio-thread copy of the parameters, refreshed from params each block
+    float paramValues[kParamCount];
+    float sampleRate;
+    // Rate of the engine and effects: the host rate, or a fraction of it in Eco mode
+    float renderRate;
+    int ecoFactor = 1;
+    int modelIdx = 0;
+    uint32_t dirtyGroups = 0;
+    uint64_t framePosition = 0; // samples rendered since activate()
+    int currentNote = -1;
+    bool noteHeld = false;
+    float midiFreq = 261.63f; // C4 until the first note
+    bool wasSilent = true;
+    PeaksADSR adsr;
+    PeaksLFO lfo;
+    // Per-sample envelope and LFO of the current sub-block
+    alignas(64) float envBlock[kMaxBlock];
+    alignas(64) float lfoBlock[kMaxBlock];
+    // Block-rate modulation: sources sampled every kMaxBlock rendered samples,
+    // on a grid of its own, so host block sizes don't move the updates
+    ModMatrix modMatrix;
+    uint32_t controlPos = 0; // rendered samples since the last update
+    float modSources[ModMatrix::kSourceCount] = {};
+    float modOffsets[ModMatrix::kDestCount] = {};
+    // Level ramps to each new target over kMaxBlock samples, however the
+    // host slices the stream: from levelFrom, levelStep per sample
+    float levelFrom = 0.0f, levelStep = 0.0f, levelTarget = 0.0f;
+    uint32_t levelRamp = 0; // samples of the ramp already played
     MoogFilter moogL, moogR;
-    ImprovedDelay delayL, delayR;
+    // The ladder runs inside these at the Quality rate
+    Oversampler filterOsL, filterOsR;
+    // Only the selected engine is constructed, on first selection
+    SynthEngines::Slot engine;
+    StereoDelay delay;
     ImprovedChorus chorusL, chorusR;
+    TruePeakLimiter limiter;
     // Improved Schroeder/Moorer reverb buffers and state
     static constexpr int numCombs = 4, numAllpasses = 2;
+    // Lengths at 48kHz; activate() scales them to the host rate
+    static constexpr int kCombLens[numCombs] = {1116, 1188, 1277, 1356}; // prime lengths for diffusion
+    static constexpr int kAllpassLens[numAllpasses] = {225, 556};
     std::vector<float> combBufL[numCombs], combBufR[numCombs];
     size_t combIdxL[numCombs] = {0}, combIdxR[numCombs] = {0};
     float combFeedback[numCombs] = {0};
     std::vector<float> allpassBufL[numAllpasses], allpassBufR[numAllpasses];
     size_t allpassIdxL[numAllpasses] = {0}, allpassIdxR[numAllpasses] = {0};
-private:
-    float sampleRate;
-    float paramValues[kParamCount];
-    SineEngine sine;
-    TriangleEngine triangle;
-    SquareEngine square;
-    SawEngine saw;
-    SuperSawEngine supersaw;
-    FaithfulVirtualAnalogEngine va;
-    FMEngine fm;
-    FormantEngine formant;
-    AdditiveEngine additive;
-    ChordEngine chord;
-    StringEngine stringRes;
-    PWMEngine pwm;
-    PeaksADSR adsr;
+    // Reverb Mode = Convolution; its tail runs on a worker thread
+    ConvolutionReverb convolution;
+    // Eco mode: the chain's output brought back to the host rate. The few
+    // samples one render overshoots a host block by wait in ecoTail.
+    PolyphaseUpsampler ecoUpL, ecoUpR;
+    static constexpr uint32_t kEcoLength = kMaxBlock * PolyphaseUpsampler::kMaxFactor + PolyphaseUpsampler::kMaxFactor;
+    alignas(64) float ecoL[kEcoLength];
+    alignas(64) float ecoR[kEcoLength];
+    float ecoTailL[PolyphaseUpsampler::kMaxFactor], ecoTailR[PolyphaseUpsampler::kMaxFactor];
+    uint32_t ecoTail = 0;
+    float envelopeOut = 0.0f; // last envelope sample, for telemetry
+
+    // Cold: written by host threads or only read for diagnostics. The store
+    // starts on its own cache line so host writes don't share lines with run().
+    alignas(64) ParamStore<kParamCount> params;
+    DeadlineMonitor deadline;
+    DspMemory dspMemory;
+    std::atomic<float> lockedKiB{0.0f};
+    TelemetryRing telemetry;
     PeaksAD ad;
-    PeaksLFO lfo;
-    int currentNote;
-    bool noteHeld;
-    float midiFreq;
+#ifdef SYNTH_PROFILE
+    StageProfiler profiler;
+#endif
 public:
-    Plugin5yn7h_() : Plugin(kParamCount, 0, 0), moogL(48000.0f), moogR(48000.0f) {
+    Plugin5yn7h_() : Plugin(kParamCount, 0, kStateCount), moogL(48000.0f), moogR(48000.0f) {
     paramValues[kParamFilterWet] = 0.0f; // Default to fully dry
-        sampleRate = 48000.0f;
-        // Set up all engines
-        sine.setSampleRate(sampleRate);
-        triangle.setSampleRate(sampleRate);
-        square.setSampleRate(sampleRate);
-        saw.setSampleRate(sampleRate);
+        // The host's rate when it knows it already; activate() applies it
+        sampleRate = getSampleRate() > 0.0 ? float(getSampleRate()) : 48000.0f;
+        renderRate = sampleRate;
         adsr.setSampleRate(sampleRate);
         ad.setSampleRate(sampleRate);
         lfo.setSampleRate(sampleRate);
@@ -159,48 +193,59 @@ public:
         paramValues[kParamLfoFreq] = 1.0f;
         paramValues[kParamLfoWave] = 0.0f;
         paramValues[kParamLfoVar] = 0.0f;
-
-    // Init improved reverb buffers (comb: 4 delays, allpass: 2 delays)
-    const int combLens[4] = {1116, 1188, 1277, 1356}; // prime lengths for diffusion
-    const int allpassLens[2] = {225, 556};
-    for (int i = 0; i < numCombs; ++i) {
-        combBufL[i].assign(combLens[i], 0.0f);
-        combBufR[i].assign(combLens[i], 0.0f);
-        combIdxL[i] = combIdxR[i] = 0;
-        combFeedback[i] = 0.0f;
-    }
-    for (int i = 0; i < numAllpasses; ++i) {
-        allpassBufL[i].assign(allpassLens[i], 0.0f);
-        allpassBufR[i].assign(allpassLens[i], 0.0f);
-        allpassIdxL[i] = allpassIdxR[i] = 0;
-    }
-    // Set all shared parameters for all engines at startup
-    float harmonics = paramValues[kParamHarmonics];
-    float timbre = paramValues[kParamTimbre];
-    float morph = paramValues[kParamMorph];
-    float freq = paramValues[kParamFreq];
-    float level = paramValues[kParamLevel];
-    sine.setFrequency(freq); sine.setHarmonics(harmonics); sine.setTimbre(timbre); sine.setMorph(morph); sine.setLevel(level);
-    triangle.setFrequency(freq); triangle.setHarmonics(harmonics); triangle.setTimbre(timbre); triangle.setMorph(morph); triangle.setLevel(level);
-    square.setFrequency(freq); square.setHarmonics(harmonics); square.setTimbre(timbre); square.setMorph(morph); square.setLevel(level);
-    saw.setFrequency(freq); saw.setHarmonics(harmonics); saw.setTimbre(timbre); saw.setMorph(morph); saw.setLevel(level);
-    supersaw.setFrequency(freq); supersaw.setHarmonics(harmonics); supersaw.setTimbre(timbre); supersaw.setMorph(morph); supersaw.setLevel(level);
-    va.setFrequency(freq); va.setHarmonics(harmonics); va.setTimbre(timbre); va.setMorph(morph); va.setLevel(level);
-    fm.setFrequency(freq); fm.setHarmonics(harmonics); fm.setTimbre(timbre); fm.setMorph(morph); fm.setLevel(level);
-    formant.setFrequency(freq); formant.setHarmonics(harmonics); formant.setTimbre(timbre); formant.setMorph(morph); formant.setLevel(level);
-    additive.setFrequency(freq); additive.setHarmonics(harmonics); additive.setTimbre(timbre); additive.setMorph(morph); additive.setLevel(level);
-    chord.setFrequency(freq); chord.setHarmonics(harmonics); chord.setTimbre(timbre); chord.setMorph(morph); chord.setLevel(level);
-    stringRes.setFrequency(freq); stringRes.setHarmonics(harmonics); stringRes.setTimbre(timbre); stringRes.setMorph(morph); stringRes.setLevel(level);
+        paramValues[kParamNearMissThreshold] = 0.8f;
+        paramValues[kParamQuality] = 1.0f; // 2x
+        // Route 1 keeps the classic LFO tremolo; the others start off
+        paramValues[kParamMod1Source] = float(ModMatrix::kSourceLfo);
+        paramValues[kParamMod1Dest] = float(ModMatrix::kDestLevel + 1);
+        paramValues[kParamMod1Amount] = 0.2f;
+        modSources[ModMatrix::kSourceVelocity] = 1.0f;
+        paramValues[kParamLimiter] = 1.0f;
+        paramValues[kParamLimiterCeiling] = -1.0f;
+        paramValues[kParamDelayTime] = 375.0f;
+        paramValues[kParamDelayFeedback] = 0.45f;
+        paramValues[kParamDelayTaps] = 1.0f;
+        paramValues[kParamDelayPingPong] = 0.0f;
+        paramValues[kParamReverbMode] = 0.0f; // Algorithmic
+        paramValues[kParamUnison] = 1.0f;
+        paramValues[kParamUnisonDetune] = 0.3f;
+        paramValues[kParamEco] = 0.0f;
+        setLatency(limiter.prepare(sampleRate));
+    // Delay, chorus and reverb buffers are allocated in activate(), so
+    // instantiation (host scans, project load) only sets parameter defaults.
+    // Publish the defaults; every parameter starts dirty so the first run() derives all state
+    for (uint32_t i = 0; i < kParamCount; ++i) params.set(i, paramValues[i]);
     }
 
     // Provide engine names for the engine parameter for host combo box
     bool getParameterValueString(uint32_t index, float value, char* str) const {
         if (index == kParamModel) {
-            int v = int(value + 0.5f);
-            extern const char* kEngineNames[];
-            if (v < 0) v = 0;
-            if (v >= kNumEngines) v = kNumEngines - 1;
-            std::strncpy(str, kEngineNames[v], 127);
+            std::strncpy(str, SynthEngines::name(int(value + 0.5f)), 127);
+            str[127] = '\0';
+            return true;
+        }
+        if (index == kParamQuality) {
+            static const char* const kQualityNames[] = { "1x", "2x", "4x", "8x" };
+            int q = int(value + 0.5f);
+            std::strncpy(str, kQualityNames[q < 0 ? 0 : (q > 3 ? 3 : q)], 127);
+            str[127] = '\0';
+            return true;
+        }
+        if (index == kParamReverbMode) {
+            std::strncpy(str, value >= 0.5f ? "Convolution" : "Algorithmic", 127);
+            str[127] = '\0';
+            return true;
+        }
+        if (index == kParamLfoSync) {
+            std::strncpy(str, kLfoDivisions[lfoDivision(value)].name, 127);
+            str[127] = '\0';
+            return true;
+        }
+        if (index >= kParamMod1Source && index <= kParamMod4Amount) {
+            const uint32_t field = (index - kParamMod1Source) % 3;
+            if (field == 2) return false;
+            const int v = int(value + 0.5f);
+            std::strncpy(str, field == 0 ? ModMatrix::sourceName(v) : ModMatrix::destinationName(v), 127);
             str[127] = '\0';
             return true;
         }
@@ -215,6 +260,10 @@ public:
 
     void initParameter(uint32_t index, Parameter& parameter) override {
         parameter.hints = kParameterIsAutomatable;
+        if (index >= kParamMod1Source && index <= kParamMod4Amount) {
+            initModParameter(index, parameter);
+            return;
+        }
         switch (index) {
         case kParamFilterWet:
             parameter.name = "Filter Wet";
@@ -241,7 +290,7 @@ public:
             parameter.ranges.max = 1.0f;
             break;
         case kParamDelay:
-            parameter.name = "Delay";
+            parameter.name = "Delay Mix";
             parameter.symbol = "delay";
             parameter.unit = "";
             parameter.ranges.def = 0.0f;
@@ -355,6 +404,102 @@ public:
             parameter.ranges.min = 0.0f;
             parameter.ranges.max = 1.0f;
             break;
+        case kParamLimiter:
+            parameter.name = "Limiter";
+            parameter.symbol = "limiter";
+            parameter.unit = "";
+            parameter.ranges.def = 1.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 1.0f;
+            parameter.hints |= kParameterIsBoolean;
+            break;
+        case kParamLimiterCeiling:
+            parameter.name = "Limiter Ceiling";
+            parameter.symbol = "limiter_ceiling";
+            parameter.unit = "dBTP";
+            parameter.ranges.def = -1.0f;
+            parameter.ranges.min = -12.0f;
+            parameter.ranges.max = 0.0f;
+            break;
+        case kParamReverbMode:
+            parameter.name = "Reverb Mode";
+            parameter.symbol = "reverb_mode";
+            parameter.unit = "";
+            parameter.ranges.def = 0.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 1.0f;
+            parameter.hints |= kParameterIsInteger;
+            break;
+        case kParamUnison:
+            parameter.name = "Unison Voices";
+            parameter.symbol = "unison";
+            parameter.unit = "";
+            parameter.ranges.def = 1.0f;
+            parameter.ranges.min = 1.0f;
+            parameter.ranges.max = float(kMaxUnison);
+            parameter.hints |= kParameterIsInteger;
+            break;
+        case kParamUnisonDetune:
+            parameter.name = "Unison Detune";
+            parameter.symbol = "unison_detune";
+            parameter.unit = "";
+            parameter.ranges.def = 0.3f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 1.0f;
+            break;
+        case kParamEco:
+            // Changes the latency, so it only takes effect when the host
+            // activates the plugin again; not automatable for that reason
+            parameter.name = "Eco Mode";
+            parameter.symbol = "eco";
+            parameter.unit = "";
+            parameter.ranges.def = 0.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 1.0f;
+            parameter.hints = kParameterIsBoolean | kParameterIsInteger;
+            break;
+        case kParamDelayTime:
+            parameter.name = "Delay Time";
+            parameter.symbol = "delay_time";
+            parameter.unit = "ms";
+            parameter.ranges.def = 375.0f;
+            parameter.ranges.min = 1.0f;
+            parameter.ranges.max = StereoDelay::kMaxTimeMs;
+            break;
+        case kParamDelayFeedback:
+            parameter.name = "Delay Feedback";
+            parameter.symbol = "delay_feedback";
+            parameter.unit = "";
+            parameter.ranges.def = 0.45f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 0.95f;
+            break;
+        case kParamDelayTaps:
+            parameter.name = "Delay Taps";
+            parameter.symbol = "delay_taps";
+            parameter.unit = "";
+            parameter.ranges.def = 1.0f;
+            parameter.ranges.min = 1.0f;
+            parameter.ranges.max = float(StereoDelay::kMaxTaps);
+            parameter.hints |= kParameterIsInteger;
+            break;
+        case kParamDelayPingPong:
+            parameter.name = "Delay Ping-Pong";
+            parameter.symbol = "delay_pingpong";
+            parameter.unit = "";
+            parameter.ranges.def = 0.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 1.0f;
+            break;
+        case kParamLfoSync:
+            parameter.name = "LFO Sync";
+            parameter.symbol = "lfo_sync";
+            parameter.unit = "";
+            parameter.ranges.def = 0.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = float(kNumLfoDivisions - 1);
+            parameter.hints |= kParameterIsInteger;
+            break;
         case kParamFilterCutoff:
             parameter.name = "Filter Cutoff";
             parameter.symbol = "filter_cutoff";
@@ -371,53 +516,223 @@ public:
             parameter.ranges.min = 0.0f;
             parameter.ranges.max = 1.0f;
             break;
+        case kParamNearMissThreshold:
+            parameter.name = "Near-Miss Threshold";
+            parameter.symbol = "near_miss_threshold";
+            parameter.unit = "";
+            parameter.ranges.def = 0.8f;
+            parameter.ranges.min = 0.1f;
+            parameter.ranges.max = 1.0f;
+            parameter.hints = 0;
+            break;
+        case kParamCpuLoadP50:
+            parameter.name = "CPU Load p50";
+            parameter.symbol = "cpu_load_p50";
+            parameter.unit = "";
+            parameter.ranges.def = 0.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 2.0f;
+            parameter.hints = kParameterIsOutput;
+            break;
+        case kParamCpuLoadP99:
+            parameter.name = "CPU Load p99";
+            parameter.symbol = "cpu_load_p99";
+            parameter.unit = "";
+            parameter.ranges.def = 0.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 2.0f;
+            parameter.hints = kParameterIsOutput;
+            break;
+        case kParamCpuLoadMax:
+            parameter.name = "CPU Load Max";
+            parameter.symbol = "cpu_load_max";
+            parameter.unit = "";
+            parameter.ranges.def = 0.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 2.0f;
+            parameter.hints = kParameterIsOutput;
+            break;
+        case kParamNearMisses:
+            parameter.name = "Near Misses";
+            parameter.symbol = "near_misses";
+            parameter.unit = "";
+            parameter.ranges.def = 0.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 1000000.0f;
+            parameter.hints = kParameterIsOutput | kParameterIsInteger;
+            break;
+        case kParamLockedMemory:
+            parameter.name = "Locked Memory";
+            parameter.symbol = "locked_memory";
+            parameter.unit = "KiB";
+            parameter.ranges.def = 0.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 65536.0f;
+            parameter.hints = kParameterIsOutput;
+            break;
+        case kParamQuality:
+            parameter.name = "Quality";
+            parameter.symbol = "quality";
+            parameter.unit = "";
+            parameter.ranges.def = 1.0f;
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = 3.0f;
+            parameter.hints |= kParameterIsInteger;
+            break;
         default:
             break;
         }
     }
 
     float getParameterValue(uint32_t index) const override {
-    if (index < kParamCount) return paramValues[index];
-    return 0.0f;
+        switch (index) {
+        case kParamCpuLoadP50: return deadline.getP50();
+        case kParamCpuLoadP99: return deadline.getP99();
+        case kParamCpuLoadMax: return deadline.getMax();
+        case kParamNearMisses: return float(deadline.getNearMisses());
+        case kParamLockedMemory: return lockedKiB.load(std::memory_order_relaxed);
+        default: break;
+        }
+        return params.get(index);
     }
 
     void setParameterValue(uint32_t index, float value) override {
-    if (index < kParamCount) paramValues[index] = value;
+        params.set(index, value);
+    }
+
+    enum States { kStateImpulseFile, kStateCount };
+
+    void initState(uint32_t index, State& state) override {
+        if (index != kStateImpulseFile) return;
+        state.key = "ir_file";
+        state.label = "Impulse Response";
+        state.description = "WAV file for the convolution reverb";
+        state.defaultValue = "";
+        state.hints = kStateIsFilenamePath;
+    }
+
+    // Host thread; decodes and transforms the file here, never in run()
+    void setState(const char* key, const char* value) override {
+        if (std::strcmp(key, "ir_file") == 0) convolution.loadFile(value);
+    }
+
+    // Route parameters come in (source, destination, amount) triples
+    void initModParameter(uint32_t index, Parameter& parameter) {
+        static const char* const kNames[ModMatrix::kRoutes][3] = {
+            { "Mod 1 Source", "Mod 1 Dest", "Mod 1 Amount" },
+            { "Mod 2 Source", "Mod 2 Dest", "Mod 2 Amount" },
+            { "Mod 3 Source", "Mod 3 Dest", "Mod 3 Amount" },
+            { "Mod 4 Source", "Mod 4 Dest", "Mod 4 Amount" },
+        };
+        static const char* const kSymbols[ModMatrix::kRoutes][3] = {
+            { "mod1_source", "mod1_dest", "mod1_amount" },
+            { "mod2_source", "mod2_dest", "mod2_amount" },
+            { "mod3_source", "mod3_dest", "mod3_amount" },
+            { "mod4_source", "mod4_dest", "mod4_amount" },
+        };
+        const uint32_t route = (index - kParamMod1Source) / 3;
+        const uint32_t field = (index - kParamMod1Source) % 3;
+        parameter.name = kNames[route][field];
+        parameter.symbol = kSymbols[route][field];
+        parameter.unit = "";
+        parameter.ranges.def = paramValues[index];
+        switch (field) {
+        case 0:
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = float(ModMatrix::kSourceCount - 1);
+            parameter.hints |= kParameterIsInteger;
+            break;
+        case 1:
+            parameter.ranges.min = 0.0f;
+            parameter.ranges.max = float(ModMatrix::kDestCount);
+            parameter.hints |= kParameterIsInteger;
+            break;
+        default:
+            parameter.ranges.min = -1.0f;
+            parameter.ranges.max = 1.0f;
+            break;
+        }
+    }
+
+    // Per-block meters and state published by run(); one reader at a time
+    TelemetryRing& getTelemetry() { return telemetry; }
+
+    // Only called while deactivated; activate() follows before the next run()
+    void sampleRateChanged(double newSampleRate) override {
+        sampleRate = float(newSampleRate);
     }
 
     void activate() override {
-        // Reset all engines
-        sine.reset();
-        triangle.reset();
-        square.reset();
-        saw.reset();
+        // Eco renders at the largest power-of-two fraction of the host rate
+        // that stays at 44.1 kHz or above: 96k -> 48k, 192k -> 48k, 88.2k -> 44.1k
+        ecoFactor = 1;
+        if (params.get(kParamEco) >= 0.5f) {
+            while (ecoFactor < PolyphaseUpsampler::kMaxFactor && sampleRate / float(2 * ecoFactor) >= 44100.0f)
+                ecoFactor *= 2;
+        }
+        renderRate = sampleRate / float(ecoFactor);
+        ecoUpL.prepare(ecoFactor); ecoUpR.prepare(ecoFactor);
+        ecoTail = 0;
+        // Engine delay lines and rings are sized for the rate they run at
+        engine.prepare(renderRate);
+        applySampleRate();
+        // Reset the live engine; the others are constructed fresh when selected
+        SynthEngines::reset(engine);
         adsr.reset();
         ad.reset();
         lfo.reset();
-        delayL.reset(); delayR.reset();
-        chorusL.reset(); chorusR.reset();
+        levelFrom = levelStep = levelTarget = 0.0f;
+        levelRamp = kMaxBlock;
+        framePosition = 0;
+        controlPos = 0;
+        deadline.reset();
+        filterOsL.reset(); filterOsR.reset();
+        // The limiter runs at the host rate, after the upsampler
+        setLatency(limiter.prepare(sampleRate) + ecoUpL.getLatency());
+        // Allocate (first activation) or clear the effect buffers
+        delay.prepare(renderRate);
+        convolution.prepare(renderRate);
+        chorusL.prepare(renderRate); chorusR.prepare(renderRate);
         for (int i = 0; i < numCombs; ++i) {
-            std::fill(combBufL[i].begin(), combBufL[i].end(), 0.0f);
-            std::fill(combBufR[i].begin(), combBufR[i].end(), 0.0f);
+            combBufL[i].assign(reverbLength(kCombLens[i]), 0.0f);
+            combBufR[i].assign(reverbLength(kCombLens[i]), 0.0f);
             combIdxL[i] = combIdxR[i] = 0;
             combFeedback[i] = 0.0f;
         }
         for (int i = 0; i < numAllpasses; ++i) {
-            std::fill(allpassBufL[i].begin(), allpassBufL[i].end(), 0.0f);
-            std::fill(allpassBufR[i].begin(), allpassBufR[i].end(), 0.0f);
+            allpassBufL[i].assign(reverbLength(kAllpassLens[i]), 0.0f);
+            allpassBufR[i].assign(reverbLength(kAllpassLens[i]), 0.0f);
             allpassIdxL[i] = allpassIdxR[i] = 0;
         }
+        prepareDspMemory();
+    }
+
+    void deactivate() override {
+        convolution.stop();
+        dspMemory.release();
+        lockedKiB.store(0.0f, std::memory_order_relaxed);
+#ifdef SYNTH_PROFILE
+        // Profile builds: dump the stage histograms to $SYNTH_PROFILE_DUMP (appended) or stderr
+        const char* path = std::getenv("SYNTH_PROFILE_DUMP");
+        FILE* f = path ? std::fopen(path, "a") : nullptr;
+        profiler.dump(f ? f : stderr);
+        if (f) std::fclose(f);
+#endif
     }
 
     void run(const float** inputs, float** outputs, uint32_t frames, const MidiEvent* midiEvents, uint32_t midiEventCount) override {
         (void)inputs;
+        const DeadlineMonitor::Clock::time_point blockStart = DeadlineMonitor::Clock::now();
         // MIDI event handling
         for (uint32_t e = 0; e < midiEventCount; ++e) {
             const MidiEvent& ev = midiEvents[e];
             if ((ev.data[0] & 0xF0) == 0x90 && ev.data[2] > 0) { // Note On
                 currentNote = ev.data[1];
+                modSources[ModMatrix::kSourceVelocity] = float(ev.data[2]) / 127.0f;
                 midiFreq = 440.0f * std::pow(2.0f, (currentNote - 69) / 12.0f);
+                dirtyGroups |= kDirtyEngine;
                 noteHeld = true;
+                SynthEngines::trigger(engine);
                 adsr.gateOn();
                 ad.gateOn();
             } else if (((ev.data[0] & 0xF0) == 0x80) || ((ev.data[0] & 0xF0) == 0x90 && ev.data[2] == 0)) { // Note Off
@@ -426,140 +741,437 @@ public:
                     adsr.gateOff();
                     ad.gateOff();
                 }
+            } else if ((ev.data[0] & 0xF0) == 0xB0 && ev.data[1] == 1) { // Mod wheel
+                modSources[ModMatrix::kSourceModWheel] = float(ev.data[2]) / 127.0f;
             }
         }
 
-    // Get engine/model selection
-    int model = static_cast<int>(paramValues[kParamModel] + 0.5f);
-    if (model < 0) model = 0;
-    if (model >= kNumEngines) model = kNumEngines - 1;
-
-        // Set shared parameters
-        float harmonics = paramValues[kParamHarmonics];
-        float timbre = paramValues[kParamTimbre];
-        float morph = paramValues[kParamMorph];
-    // float freq = paramValues[kParamFreq]; // Removed unused variable
-        float level = paramValues[kParamLevel];
-
-        // Peaks params
-        float attack = paramValues[kParamAttack];
-        float decay = paramValues[kParamDecay];
-        float sustain = paramValues[kParamSustain];
-        float release = paramValues[kParamRelease];
-        float lfoFreq = paramValues[kParamLfoFreq];
-        float lfoWave = paramValues[kParamLfoWave];
-        float lfoVar = paramValues[kParamLfoVar];
-
-        // Envelope and LFO setup
-    adsr.setAttack(attack);
-    adsr.setDecay(decay);
-    adsr.setSustain(sustain);
-    adsr.setRelease(release);
-    // ad.setAttack(attack); // PeaksAD does not have setAttack
-    // ad.setDecay(decay);  // PeaksAD does not have setDecay
-    lfo.setFrequency(lfoFreq);
-    lfo.setWaveform(static_cast<PeaksLFO::Waveform>(static_cast<int>(lfoWave)));
-    lfo.setVariation(lfoVar);
-
-
-
-    float reverbAmount = paramValues[kParamReverb];
-    float delayAmt = paramValues[kParamDelay];
-    float chorusAmt = paramValues[kParamChorus];
-    static bool wasSilent = true;
-    for (uint32_t i = 0; i < frames; ++i) {
-    float dryL = 0.0f, dryR = 0.0f;
-    // --- Moog filter before effects ---
-    float filterCutoff = paramValues[kParamFilterCutoff];
-    float filterResonance = paramValues[kParamFilterResonance];
-    float cutoffHz = 40.0f + filterCutoff * (18000.0f - 40.0f);
-    moogL.setCutoff(cutoffHz);
-    moogR.setCutoff(cutoffHz);
-    moogL.setResonance(filterResonance);
-    moogR.setResonance(filterResonance);
-        float env = adsr.process();
-        float lfoVal = lfo.process();
-    // Use midiFreq for all engines so each note plays the correct pitch
-    float noteFreq = midiFreq;
-        bool silent = (env <= 0.0001f);
-        if (silent && !wasSilent) { delayL.reset(); delayR.reset(); chorusL.reset(); chorusR.reset(); }
-        wasSilent = silent;
-    // Maximally robust engine selection: clamp, round, always allow engine 0
-    float rawModel = paramValues[kParamModel];
-    // Clamp to valid range before rounding
-    if (rawModel < 0.0f) rawModel = 0.0f;
-    if (rawModel > float(kNumEngines - 1)) rawModel = float(kNumEngines - 1);
-    int modelIdx = int(std::round(rawModel));
-    // If value is very close to zero, always select engine 0
-    if (paramValues[kParamModel] >= -0.5f && paramValues[kParamModel] < 0.5f) modelIdx = 0;
-    // Fallback: if out of range, select engine 0
-    if (modelIdx < 0 || modelIdx >= kNumEngines) modelIdx = 0;
-    switch (modelIdx) {
-            case 0: sine.setFrequency(noteFreq); sine.setHarmonics(harmonics); sine.setTimbre(timbre); sine.setMorph(morph); dryL = dryR = sine.process(); break;
-            case 1: triangle.setFrequency(noteFreq); triangle.setHarmonics(harmonics); triangle.setTimbre(timbre); triangle.setMorph(morph); dryL = dryR = triangle.process(); break;
-            case 2: square.setFrequency(noteFreq); square.setHarmonics(harmonics); square.setTimbre(timbre); square.setMorph(morph); dryL = dryR = square.process(); break;
-            case 3: saw.setFrequency(noteFreq); saw.setHarmonics(harmonics); saw.setTimbre(timbre); saw.setMorph(morph); dryL = dryR = saw.process(); break;
-            case 4: supersaw.setSampleRate(sampleRate); supersaw.setFrequency(noteFreq); supersaw.setHarmonics(harmonics); supersaw.setTimbre(timbre); supersaw.setMorph(morph); supersaw.process(dryL, dryR); break;
-            case 5: va.setSampleRate(sampleRate); va.setFrequency(noteFreq); va.setHarmonics(harmonics); va.setTimbre(timbre); va.setMorph(morph); va.process(dryL, dryR); break;
-            case 6: fm.setFrequency(noteFreq); fm.setHarmonics(harmonics); fm.setTimbre(timbre); fm.setMorph(morph); fm.process(dryL, dryR); break;
-            case 7: formant.setFrequency(noteFreq); formant.setHarmonics(harmonics); formant.setTimbre(timbre); formant.setMorph(morph); formant.process(dryL, dryR); break;
-            case 8: additive.setFrequency(noteFreq); additive.setHarmonics(harmonics); additive.setTimbre(timbre); additive.setMorph(morph); additive.process(dryL, dryR); break;
-            case 9: chord.setFrequency(noteFreq); chord.setHarmonics(harmonics); chord.setTimbre(timbre); chord.setMorph(morph); chord.process(dryL, dryR); break;
-            case 10: stringRes.setSampleRate(sampleRate); stringRes.setFrequency(noteFreq); stringRes.setHarmonics(harmonics); stringRes.setTimbre(timbre); stringRes.setMorph(morph); stringRes.process(dryL, dryR); break;
-            case 11: pwm.setSampleRate(sampleRate); pwm.setFrequency(noteFreq); pwm.setHarmonics(harmonics); pwm.setTimbre(timbre); pwm.setMorph(morph); pwm.setLevel(level); pwm.process(dryL, dryR); break;
-            default: dryL = dryR = 0.0f; break;
-        }
-        float lfoMod = 1.0f + 0.2f * lfoVal;
-        dryL = dryL * env * level * lfoMod;
-        dryR = dryR * env * level * lfoMod;
-    // --- Process through Moog filter and blend wet/dry ---
-    float filterWet = paramValues[kParamFilterWet];
-    float filteredL = moogL.process(dryL);
-    float filteredR = moogR.process(dryR);
-    dryL = dryL * (1.0f - filterWet) + filteredL * filterWet;
-    dryR = dryR * (1.0f - filterWet) + filteredR * filterWet;
-    // --- Apply delay and chorus effects ---
-    dryL = delayL.process(dryL, delayAmt, sampleRate);
-    dryR = delayR.process(dryR, delayAmt, sampleRate);
-    dryL = chorusL.process(dryL, chorusAmt, sampleRate);
-    dryR = chorusR.process(dryR, chorusAmt, sampleRate);
-        // --- Improved Schroeder/Moorer reverb ---
-        // 4 parallel combs per channel
-        float combOutL = 0.0f, combOutR = 0.0f;
-        float combFeedbackAmt = 0.75f + 0.22f * reverbAmount; // 0.75-0.97
-        for (int c = 0; c < numCombs; ++c) {
-            float inL = dryL + combFeedback[c] * combBufL[c][combIdxL[c]];
-            float inR = dryR + combFeedback[c] * combBufR[c][combIdxR[c]];
-            combOutL += combBufL[c][combIdxL[c]];
-            combOutR += combBufR[c][combIdxR[c]];
-            combFeedback[c] = combFeedbackAmt;
-            combBufL[c][combIdxL[c]] = inL;
-            combBufR[c][combIdxR[c]] = inR;
-            combIdxL[c] = (combIdxL[c] + 1) % combBufL[c].size();
-            combIdxR[c] = (combIdxR[c] + 1) % combBufR[c].size();
-        }
-        combOutL /= numCombs;
-        combOutR /= numCombs;
-        // 2 series allpasses per channel
-        float apL = combOutL, apR = combOutR;
-        for (int a = 0; a < numAllpasses; ++a) {
-            float bufOutL = allpassBufL[a][allpassIdxL[a]];
-            float bufOutR = allpassBufR[a][allpassIdxR[a]];
-            float inL = apL + 0.5f * bufOutL;
-            float inR = apR + 0.5f * bufOutR;
-            allpassBufL[a][allpassIdxL[a]] = inL;
-            allpassBufR[a][allpassIdxR[a]] = inR;
-            apL = -0.5f * inL + bufOutL;
-            apR = -0.5f * inR + bufOutR;
-            allpassIdxL[a] = (allpassIdxL[a] + 1) % allpassBufL[a].size();
-            allpassIdxR[a] = (allpassIdxR[a] + 1) % allpassBufR[a].size();
-        }
-        // Mix dry and wet
-        float outL = dryL * (1.0f - reverbAmount) + apL * reverbAmount;
-        float outR = dryR * (1.0f - reverbAmount) + apR * reverbAmount;
-        outputs[0][i] = outL;
-        if (outputs[1]) outputs[1][i] = outR;
+        // Pick up parameter changes and re-derive only what they affect
+        params.consume([this](uint32_t index, float value) {
+            paramValues[index] = value;
+            dirtyGroups |= parameterGroup(index);
+        });
+        if (dirtyGroups & kDirtyEnvelope) {
+            adsr.setAttack(paramValues[kParamAttack]);
+            adsr.setDecay(paramValues[kParamDecay]);
+            adsr.setSustain(paramValues[kParamSustain]);
+            adsr.setRelease(paramValues[kParamRelease]);
+        }
+        if (dirtyGroups & kDirtyLfo) {
+            lfo.setFrequency(paramValues[kParamLfoFreq]);
+            lfo.setWaveform(static_cast<PeaksLFO::Waveform>(static_cast<int>(paramValues[kParamLfoWave])));
+            lfo.setVariation(paramValues[kParamLfoVar]);
+        }
+        if (dirtyGroups & kDirtyModMatrix) {
+            modMatrix.clear();
+            for (int r = 0; r < ModMatrix::kRoutes; ++r) {
+                const float* route = paramValues + kParamMod1Source + 3 * r;
+                const int dest = int(std::round(route[1])) - 1; // 0 is Off
+                modMatrix.addRoute(int(std::round(route[0])), dest, route[2]);
+            }
+        }
+        if (dirtyGroups & kDirtyFilter) {
+            // Moog filter before effects, at the oversampled rate
+            const int factor = oversamplingFactor();
+            filterOsL.setFactor(factor);
+            filterOsR.setFactor(factor);
+            moogL.setSampleRate(renderRate * float(factor));
+            moogR.setSampleRate(renderRate * float(factor));
+            setFilterCutoff(modulated(ModMatrix::kDestCutoff, kParamFilterCutoff));
+            moogL.setResonance(paramValues[kParamFilterResonance]);
+            moogR.setResonance(paramValues[kParamFilterResonance]);
+        }
+        if (dirtyGroups & kDirtyEngine) {
+            // Maximally robust engine selection: clamp, round, always allow engine 0
+            float rawModel = paramValues[kParamModel];
+            if (rawModel < 0.0f) rawModel = 0.0f;
+            if (rawModel > float(kNumEngines - 1)) rawModel = float(kNumEngines - 1);
+            modelIdx = SynthEngines::clampIndex(int(std::round(rawModel)));
+            engine.select(modelIdx);
+            updateEngine();
+        }
+        if (dirtyGroups & kDirtyMonitor) deadline.setThreshold(paramValues[kParamNearMissThreshold]);
+        if (dirtyGroups & kDirtyLimiter) limiter.setCeiling(paramValues[kParamLimiterCeiling]);
+        if (dirtyGroups & kDirtyDelay) {
+            delay.setTime(paramValues[kParamDelayTime]);
+            delay.setFeedback(paramValues[kParamDelayFeedback]);
+            delay.setTaps(int(paramValues[kParamDelayTaps] + 0.5f));
+            delay.setPingPong(paramValues[kParamDelayPingPong]);
+        }
+        dirtyGroups = 0;
+        syncLfo();
+
+        // Each sub-block runs the chain stage by stage so every stage can be
+        // timed (and later vectorized) on its own. In Eco mode a sub-block
+        // covers up to ecoFactor times more host frames, rendered at the
+        // reduced rate and upsampled; the limiter always runs at the host rate.
+        float peakL = 0.0f, peakR = 0.0f, sumL = 0.0f, sumR = 0.0f;
+        for (uint32_t offset = 0; offset < frames;) {
+            // Without Eco, a sub-block ends at the next control update
+            const uint32_t n = std::min<uint32_t>(ecoFactor == 1 ? kMaxBlock - controlPos : kMaxBlock * uint32_t(ecoFactor),
+                                                  frames - offset);
+            float* outL = blockL;
+            float* outR = blockR;
+            if (ecoFactor == 1) {
+                renderChain(n);
+            } else {
+                renderEco(n);
+                outL = ecoL;
+                outR = ecoR;
+            }
+            {
+                SYNTH_PROFILE_SCOPE(profiler, kStageLimiter);
+                limiter.process(outL, outR, n, paramValues[kParamLimiter] >= 0.5f);
+            }
+            for (uint32_t i = 0; i < n; ++i) {
+                peakL = std::max(peakL, std::fabs(outL[i]));
+                peakR = std::max(peakR, std::fabs(outR[i]));
+                sumL += outL[i] * outL[i];
+                sumR += outR[i] * outR[i];
+            }
+            std::copy(outL, outL + n, outputs[0] + offset);
+            if (outputs[1]) std::copy(outR, outR + n, outputs[1] + offset);
+            offset += n;
+        }
+        SYNTH_PROFILE_END_BLOCK(profiler);
+        const float load = deadline.endBlock(blockStart, frames, sampleRate);
+        if (frames > 0) {
+            TelemetryBlock t;
+            t.frame = framePosition;
+            t.frames = frames;
+            t.engine = modelIdx;
+            t.peakL = peakL;
+            t.peakR = peakR;
+            t.rmsL = std::sqrt(sumL / float(frames));
+            t.rmsR = std::sqrt(sumR / float(frames));
+            t.envelope = envelopeOut;
+            t.load = load;
+            telemetry.push(t);
+        }
+        framePosition += frames;
+    }
+
+private:
+    // Engine through reverb over n <= kMaxBlock samples of blockL/blockR, at renderRate
+    void renderChain(uint32_t n) {
+        uint32_t resetAt = n;
+        {
+            SYNTH_PROFILE_SCOPE(profiler, kStageEngine);
+            modulate(n);
+            resetAt = renderEngine(n);
+        }
+        {
+            SYNTH_PROFILE_SCOPE(profiler, kStageFilter);
+            processFilter(n);
+        }
+        {
+            SYNTH_PROFILE_SCOPE(profiler, kStageDelay);
+            processDelay(n, resetAt);
+        }
+        {
+            SYNTH_PROFILE_SCOPE(profiler, kStageChorus);
+            processChorus(n, resetAt);
+        }
+        {
+            SYNTH_PROFILE_SCOPE(profiler, kStageReverb);
+            processReverb(n);
+        }
+        envelopeOut = envBlock[n - 1];
+        controlPos = (controlPos + n) % kMaxBlock;
+    }
+
+    // n <= kMaxBlock * ecoFactor host frames into ecoL/ecoR: the tail left by
+    // the previous call, then just enough of the chain to cover the rest
+    void renderEco(uint32_t n) {
+        const uint32_t factor = uint32_t(ecoFactor);
+        std::copy(ecoTailL, ecoTailL + ecoTail, ecoL);
+        std::copy(ecoTailR, ecoTailR + ecoTail, ecoR);
+        uint32_t ready = ecoTail;
+        // In pieces that end at the next control update
+        while (n > ready) {
+            const uint32_t m = std::min((n - ready + factor - 1) / factor, kMaxBlock - controlPos);
+            renderChain(m);
+            ecoUpL.process(blockL, m, ecoL + ready);
+            ecoUpR.process(blockR, m, ecoR + ready);
+            ready += m * factor;
+        }
+        ecoTail = ready - n;
+        std::copy(ecoL + n, ecoL + ready, ecoTailL);
+        std::copy(ecoR + n, ecoR + ready, ecoTailR);
+    }
+
+    // Everything derived from the rate, pushed before the buffers are sized.
+    // The filter and engine are set directly rather than through dirtyGroups
+    // so the first block after a rate change runs no coefficient updates.
+    void applySampleRate() {
+        adsr.setSampleRate(renderRate);
+        ad.setSampleRate(renderRate);
+        lfo.setSampleRate(renderRate);
+        const int factor = oversamplingFactor();
+        moogL.setSampleRate(renderRate * float(factor));
+        moogR.setSampleRate(renderRate * float(factor));
+        updateEngine();
+    }
+
+    // Reverb line of `samples` at 48kHz, at the current rate
+    size_t reverbLength(int samples) const {
+        return size_t(std::max(1L, std::lround(float(samples) * renderRate / 48000.0f)));
+    }
+
+    // Prefault (and with SYNTH_MLOCK, lock) everything run() touches, so the
+    // first block after load doesn't page-fault. The hot member section runs
+    // from blockL up to params; the engine slot lives inside it. The deadline
+    // monitor and telemetry ring sit in the cold section for the readers'
+    // sake, but run() writes them every block.
+    void prepareDspMemory() {
+        dspMemory.release();
+        dspMemory.add(blockL, size_t(reinterpret_cast<const char*>(&params) - reinterpret_cast<const char*>(blockL)));
+        dspMemory.add(&deadline, sizeof(deadline));
+        dspMemory.add(&telemetry, sizeof(telemetry));
+#ifdef SYNTH_PROFILE
+        dspMemory.add(&profiler, sizeof(profiler));
+#endif
+        dspMemory.add(engine.buffer(), engine.bufferBytes());
+        dspMemory.addVector(delay.buf);
+        dspMemory.addVector(chorusL.buf); dspMemory.addVector(chorusR.buf);
+        for (int i = 0; i < numCombs; ++i) { dspMemory.addVector(combBufL[i]); dspMemory.addVector(combBufR[i]); }
+        for (int i = 0; i < numAllpasses; ++i) { dspMemory.addVector(allpassBufL[i]); dspMemory.addVector(allpassBufR[i]); }
+        convolution.registerMemory(dspMemory);
+        lockedKiB.store(float(dspMemory.lockedBytes()) / 1024.0f, std::memory_order_relaxed);
+    }
+
+    // Derived state groups; a parameter change only recomputes its own group
+    enum DirtyGroup : uint32_t {
+        kDirtyEnvelope  = 1 << 0,
+        kDirtyLfo       = 1 << 1,
+        kDirtyFilter    = 1 << 2,
+        kDirtyEngine    = 1 << 3,
+        kDirtyMonitor   = 1 << 4,
+        kDirtyModMatrix = 1 << 5,
+        kDirtyLimiter   = 1 << 6,
+        kDirtyDelay     = 1 << 7,
+    };
+
+    static uint32_t parameterGroup(uint32_t index) {
+        switch (index) {
+        case kParamAttack: case kParamDecay: case kParamSustain: case kParamRelease:
+            return kDirtyEnvelope;
+        case kParamLfoFreq: case kParamLfoWave: case kParamLfoVar: case kParamLfoSync:
+            return kDirtyLfo;
+        case kParamFilterCutoff: case kParamFilterResonance:
+            return kDirtyFilter;
+        case kParamModel: case kParamHarmonics: case kParamTimbre: case kParamMorph:
+        case kParamUnison: case kParamUnisonDetune:
+            return kDirtyEngine;
+        case kParamNearMissThreshold:
+            return kDirtyMonitor;
+        case kParamQuality:
+            return kDirtyEngine | kDirtyFilter;
+        case kParamLimiterCeiling:
+            return kDirtyLimiter;
+        case kParamDelayTime: case kParamDelayFeedback: case kParamDelayTaps: case kParamDelayPingPong:
+            return kDirtyDelay;
+        case kParamMod1Source: case kParamMod1Dest: case kParamMod1Amount:
+        case kParamMod2Source: case kParamMod2Dest: case kParamMod2Amount:
+        case kParamMod3Source: case kParamMod3Dest: case kParamMod3Amount:
+        case kParamMod4Source: case kParamMod4Dest: case kParamMod4Amount:
+            // A dropped route has to hand its destinations back to the parameters
+            return kDirtyModMatrix | kDirtyEngine | kDirtyFilter;
+        case kParamEco:
+            return 0; // applied by the next activate()
+        default:
+            // Level, effect amounts and filter wet are read directly by their stages
+            return 0;
+        }
+    }
+
+    // Push note frequency and shared parameters into the selected engine
+    void updateEngine() {
+        EngineControls controls;
+        controls.sampleRate = renderRate;
+        // Use midiFreq for all engines so each note plays the correct pitch
+        controls.frequency = midiFreq;
+        controls.harmonics = modulated(ModMatrix::kDestHarmonics, kParamHarmonics);
+        controls.timbre = modulated(ModMatrix::kDestTimbre, kParamTimbre);
+        controls.morph = modulated(ModMatrix::kDestMorph, kParamMorph);
+        controls.oversampling = oversamplingFactor();
+        controls.unison = int(paramValues[kParamUnison] + 0.5f);
+        controls.unisonDetune = paramValues[kParamUnisonDetune];
+        SynthEngines::update(engine, controls);
+    }
+
+    // Quality tier 0..3 -> 1x/2x/4x/8x
+    int oversamplingFactor() const {
+        int q = int(std::round(paramValues[kParamQuality]));
+        return 1 << (q < 0 ? 0 : (q > 3 ? 3 : q));
+    }
+
+    static int lfoDivision(float value) {
+        const int d = int(value + 0.5f);
+        return d < 0 ? 0 : (d >= kNumLfoDivisions ? kNumLfoDivisions - 1 : d);
+    }
+
+    // Tempo-synced LFO: the rate follows the host tempo and, while the
+    // transport rolls, the phase is taken from the song position (restarting
+    // on every bar for note divisions), so instances stay in step. Without
+    // usable BBT info (some hosts flag it valid with a zero meter or tick
+    // resolution) the LFO keeps its last rate.
+    void syncLfo() {
+        const LfoDivision& division = kLfoDivisions[lfoDivision(paramValues[kParamLfoSync])];
+        const TimePosition& pos = getTimePosition();
+        if (division.quarters == 0.0 && division.bars == 0.0) return;
+        if (!pos.bbt.valid || pos.bbt.beatsPerMinute <= 0.0 || pos.bbt.beatType <= 0.0f
+            || pos.bbt.beatsPerBar <= 0.0f || pos.bbt.ticksPerBeat <= 0.0) return;
+        const double quartersPerBeat = 4.0 / pos.bbt.beatType;
+        const double barQuarters = pos.bbt.beatsPerBar * quartersPerBeat;
+        const double length = division.quarters + division.bars * barQuarters;
+        lfo.setFrequency(float(pos.bbt.beatsPerMinute / 60.0 * quartersPerBeat / length));
+        if (!pos.playing) return;
+        const double beatInBar = (pos.bbt.beat - 1) + pos.bbt.tick / pos.bbt.ticksPerBeat;
+        double cycles;
+        if (division.bars > 0.0) {
+            cycles = (double(pos.bbt.bar - 1) + beatInBar / pos.bbt.beatsPerBar) / division.bars;
+        } else {
+            const double perBar = std::ceil(barQuarters / division.quarters);
+            cycles = double(pos.bbt.bar - 1) * perBar + beatInBar * quartersPerBeat / division.quarters;
+        }
+        const double whole = std::floor(cycles);
+        lfo.setPhase(float(cycles - whole), uint32_t(int64_t(whole)));
     }
+
+    // Parameter plus its modulation offset, kept in 0..1
+    float modulated(ModMatrix::Destination dest, uint32_t param) const {
+        return std::clamp(paramValues[param] + modOffsets[dest], 0.0f, 1.0f);
+    }
+
+    void setFilterCutoff(float normalized) {
+        float cutoffHz = 40.0f + normalized * (18000.0f - 40.0f);
+        moogL.setCutoff(cutoffHz);
+        moogR.setCutoff(cutoffHz);
+    }
+
+    // Runs the envelope and LFO for the sub-block, samples them at its start
+    // and pushes the matrix output into whatever it targets. Untargeted
+    // destinations are left alone, so an empty matrix costs one evaluate().
+    void modulate(uint32_t n) {
+        adsr.processBlock(envBlock, n);
+        lfo.processBlock(lfoBlock, n);
+        if (controlPos != 0) return;
+        modSources[ModMatrix::kSourceLfo] = lfoBlock[0];
+        modSources[ModMatrix::kSourceEnvelope] = envBlock[0];
+        modMatrix.evaluate(modSources, modOffsets);
+        constexpr uint32_t kEngineDests = (1u << ModMatrix::kDestHarmonics) | (1u << ModMatrix::kDestTimbre)
+                                        | (1u << ModMatrix::kDestMorph);
+        if (modMatrix.targetsAny(kEngineDests)) updateEngine();
+        if (modMatrix.targets(ModMatrix::kDestCutoff))
+            setFilterCutoff(modulated(ModMatrix::kDestCutoff, kParamFilterCutoff));
+    }
+
+    // Renders the selected engine into blockL/R with envelope and level
+    // applied; the modulated level is ramped across the sub-block. Returns the
+    // index at which the envelope fell silent (the delay and chorus tails are
+    // cleared there), or n if it did not.
+    uint32_t renderEngine(uint32_t n) {
+        SynthEngines::render(engine, blockL, blockR, n);
+        const float target = paramValues[kParamLevel] * std::max(0.0f, 1.0f + modOffsets[ModMatrix::kDestLevel]);
+        if (target != levelTarget) {
+            levelFrom = levelRamp < kMaxBlock ? levelFrom + levelStep * float(levelRamp) : levelTarget;
+            levelStep = (target - levelFrom) / float(kMaxBlock);
+            levelTarget = target;
+            levelRamp = 0;
+        }
+        uint32_t resetAt = n;
+        for (uint32_t i = 0; i < n; ++i) {
+            float env = envBlock[i];
+            bool silent = (env <= 0.0001f);
+            if (silent && !wasSilent) resetAt = i;
+            wasSilent = silent;
+            if (levelRamp < kMaxBlock) ++levelRamp;
+            float gain = env * (levelRamp < kMaxBlock ? levelFrom + levelStep * float(levelRamp) : levelTarget);
+            blockL[i] *= gain;
+            blockR[i] *= gain;
+        }
+        return resetAt;
+    }
+
+    // Moog filter (oversampled) with wet/dry blend
+    void processFilter(uint32_t n) {
+        float filterWet = paramValues[kParamFilterWet];
+        float filteredL[kMaxBlock], filteredR[kMaxBlock];
+        std::copy(blockL, blockL + n, filteredL);
+        std::copy(blockR, blockR + n, filteredR);
+        filterOsL.process(filteredL, n, [this](float x) { return moogL.process(x); });
+        filterOsR.process(filteredR, n, [this](float x) { return moogR.process(x); });
+        for (uint32_t i = 0; i < n; ++i) {
+            blockL[i] = blockL[i] * (1.0f - filterWet) + filteredL[i] * filterWet;
+            blockR[i] = blockR[i] * (1.0f - filterWet) + filteredR[i] * filterWet;
+        }
+    }
+
+    void processDelay(uint32_t n, uint32_t resetAt) {
+        const float mix = modulated(ModMatrix::kDestDelay, kParamDelay);
+        if (resetAt < n) {
+            delay.process(blockL, blockR, resetAt, mix);
+            delay.reset();
+            delay.process(blockL + resetAt, blockR + resetAt, n - resetAt, mix);
+        } else {
+            delay.process(blockL, blockR, n, mix);
+        }
+    }
+
+    void processChorus(uint32_t n, uint32_t resetAt) {
+        float chorusAmt = modulated(ModMatrix::kDestChorus, kParamChorus);
+        for (uint32_t i = 0; i < n; ++i) {
+            if (i == resetAt) { chorusL.reset(); chorusR.reset(); }
+            blockL[i] = chorusL.process(blockL[i], chorusAmt, renderRate);
+            blockR[i] = chorusR.process(blockR[i], chorusAmt, renderRate);
+        }
+    }
+
+    // Improved Schroeder/Moorer reverb
+    void processReverb(uint32_t n) {
+        float reverbAmount = modulated(ModMatrix::kDestReverb, kParamReverb);
+        // Without an impulse response the convolution mode falls back to the combs
+        if (convolution.impulseReady() && paramValues[kParamReverbMode] >= 0.5f) {
+            convolution.process(blockL, blockR, n, reverbAmount);
+            return;
+        }
+        float combFeedbackAmt = 0.75f + 0.22f * reverbAmount; // 0.75-0.97
+        for (uint32_t i = 0; i < n; ++i) {
+            float dryL = blockL[i], dryR = blockR[i];
+            // 4 parallel combs per channel
+            float combOutL = 0.0f, combOutR = 0.0f;
+            for (int c = 0; c < numCombs; ++c) {
+                float inL = dryL + combFeedback[c] * combBufL[c][combIdxL[c]];
+                float inR = dryR + combFeedback[c] * combBufR[c][combIdxR[c]];
+                combOutL += combBufL[c][combIdxL[c]];
+                combOutR += combBufR[c][combIdxR[c]];
+                combFeedback[c] = combFeedbackAmt;
+                combBufL[c][combIdxL[c]] = inL;
+                combBufR[c][combIdxR[c]] = inR;
+                combIdxL[c] = (combIdxL[c] + 1) % combBufL[c].size();
+                combIdxR[c] = (combIdxR[c] + 1) % combBufR[c].size();
+            }
+            combOutL /= numCombs;
+            combOutR /= numCombs;
+            // 2 series allpasses per channel
+            float apL = combOutL, apR = combOutR;
+            for (int a = 0; a < numAllpasses; ++a) {
+                float bufOutL = allpassBufL[a][allpassIdxL[a]];
+                float bufOutR = allpassBufR[a][allpassIdxR[a]];
+                float inL = apL + 0.5f * bufOutL;
+                float inR = apR + 0.5f * bufOutR;
+                allpassBufL[a][allpassIdxL[a]] = inL;
+                allpassBufR[a][allpassIdxR[a]] = inR;
+                apL = -0.5f * inL + bufOutL;
+                apR = -0.5f * inR + bufOutR;
+                allpassIdxL[a] = (allpassIdxL[a] + 1) % allpassBufL[a].size();
+                allpassIdxR[a] = (allpassIdxR[a] + 1) % allpassBufR[a].size();
+            }
+            // Mix dry and wet
+            blockL[i] = dryL * (1.0f - reverbAmount) + apL * reverbAmount;
+            blockR[i] = dryR * (1.0f - reverbAmount) + apR * reverbAmount;
+        }
     }
 };
 
@@ -14,10 +14,10 @@
 #define DISTRHO_PLUGIN_NUM_OUTPUTS 2
 #define DISTRHO_PLUGIN_WANT_MIDI_INPUT 1
 #define DISTRHO_PLUGIN_WANT_MIDI_OUTPUT 0
-#define DISTRHO_PLUGIN_WANT_STATE  0
+#define DISTRHO_PLUGIN_WANT_STATE  1
 #define DISTRHO_PLUGIN_WANT_PROGRAMS 0
-#define DISTRHO_PLUGIN_WANT_TIMEPOS 0
-#define DISTRHO_PLUGIN_WANT_LATENCY 0
+#define DISTRHO_PLUGIN_WANT_TIMEPOS 1
+#define DISTRHO_PLUGIN_WANT_LATENCY 1
 #define DISTRHO_PLUGIN_WANT_DIRECT_ACCESS 0
 #define DISTRHO_PLUGIN_WANT_ALL_PARAM_VALUES 0
 #define DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST 0
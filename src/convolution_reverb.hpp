@@ -0,0 +1,544 @@
+// convolution_reverb.hpp - Partitioned convolution reverb
+// The impulse response is split between two uniformly partitioned overlap-save
+// convolvers: the head (the first kHeadLength samples) in 64-sample partitions
+// on the audio thread, and the tail in kTailBlock partitions on a worker thread.
+// Each complete tail block of input is handed to the worker through an SPSC
+// ring; its result is first heard two blocks later, so the worker has two
+// whole blocks of slack. The audio thread never waits for it: a late block is
+// dropped (that stretch of tail is silent) instead.
+// The send is mono and the IR stereo, so one complex FFT carries both outputs
+// (left in the real part, right in the imaginary part).
+// Everything is sized for the IR that is loaded; without one there are no
+// buffers and no worker. IR files are memory-mapped and decoded off the audio
+// thread, which also builds a whole new Convolver for them; the audio thread
+// swaps it in at its next block and hands the old one back to be freed.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "engines/fft.h"
+#include "dsp_memory.hpp"
+#include "spsc_ring.hpp"
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Counting semaphore; post() never blocks, so the audio thread may call it
+class WorkerSignal {
+public:
+#if defined(_WIN32)
+    WorkerSignal() : handle(CreateSemaphoreA(nullptr, 0, 0x7fffffff, nullptr)) {}
+    ~WorkerSignal() { CloseHandle(handle); }
+    void post() { ReleaseSemaphore(handle, 1, nullptr); }
+    void wait() { WaitForSingleObject(handle, INFINITE); }
+private:
+    HANDLE handle;
+#elif defined(__APPLE__)
+    WorkerSignal() : handle(dispatch_semaphore_create(0)) {}
+    ~WorkerSignal() { dispatch_release(handle); }
+    void post() { dispatch_semaphore_signal(handle); }
+    void wait() { dispatch_semaphore_wait(handle, DISPATCH_TIME_FOREVER); }
+private:
+    dispatch_semaphore_t handle;
+#else
+    WorkerSignal() { sem_init(&handle, 0, 0); }
+    ~WorkerSignal() { sem_destroy(&handle); }
+    void post() { sem_post(&handle); }
+    void wait() { while (sem_wait(&handle) != 0) {} } // retry on EINTR
+private:
+    sem_t handle;
+#endif
+};
+
+// Read-only view of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const char* path) {
+#if defined(_WIN32)
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER length;
+        if (!GetFileSizeEx(file, &length) || length.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return;
+        bytes = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (bytes) length_ = size_t(length.QuadPart);
+#else
+        const int fd = open(path, O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* p = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                bytes = static_cast<const uint8_t*>(p);
+                length_ = size_t(info.st_size);
+            }
+        }
+        close(fd); // the mapping keeps the file open
+#endif
+    }
+    ~MappedFile() {
+#if defined(_WIN32)
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (bytes) munmap(const_cast<uint8_t*>(bytes), length_);
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length_; }
+
+private:
+    const uint8_t* bytes = nullptr;
+    size_t length_ = 0;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+};
+
+// Impulse response as read from disk, at the file's sample rate
+struct ImpulseResponse {
+    std::vector<float> left, right;
+    float sampleRate = 0.0f;
+
+    // PCM (16/24/32-bit) or IEEE float (32/64-bit) WAV, including
+    // WAVE_FORMAT_EXTENSIBLE. Mono files fill both channels; channels past the
+    // second are ignored.
+    bool load(const char* path) {
+        MappedFile file(path);
+        const uint8_t* p = file.data();
+        const size_t size = file.size();
+        if (!p || size < 12 || std::memcmp(p, "RIFF", 4) != 0 || std::memcmp(p + 8, "WAVE", 4) != 0) return false;
+        uint32_t format = 0, channels = 0, rate = 0, bits = 0;
+        const uint8_t* pcm = nullptr;
+        size_t pcmBytes = 0;
+        for (size_t pos = 12; pos + 8 <= size;) {
+            const uint8_t* id = p + pos;
+            const size_t body = pos + 8;
+            const size_t length = std::min<size_t>(le(p + pos + 4, 4), size - body);
+            if (std::memcmp(id, "fmt ", 4) == 0 && length >= 16) {
+                format = le(p + body, 2);
+                channels = le(p + body + 2, 2);
+                rate = le(p + body + 4, 4);
+                bits = le(p + body + 14, 2);
+                if (format == 0xfffe && length >= 26) format = le(p + body + 24, 2); // sub-format GUID
+            } else if (std::memcmp(id, "data", 4) == 0) {
+                pcm = p + body;
+                pcmBytes = length;
+            }
+            pos = body + length + (length & 1);
+        }
+        const bool isInt = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+        const bool isFloat = format == 3 && (bits == 32 || bits == 64);
+        if (!pcm || channels == 0 || rate == 0 || !(isInt || isFloat)) return false;
+        const size_t width = bits / 8, stride = width * channels;
+        const size_t frames = pcmBytes / stride;
+        if (frames == 0) return false;
+        left.resize(frames);
+        right.resize(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            const uint8_t* frame = pcm + i * stride;
+            left[i] = decode(frame, bits, isFloat);
+            right[i] = channels > 1 ? decode(frame + width, bits, isFloat) : left[i];
+        }
+        sampleRate = float(rate);
+        return true;
+    }
+
+private:
+    static uint32_t le(const uint8_t* p, int bytes) {
+        uint32_t v = 0;
+        for (int i = bytes - 1; i >= 0; --i) v = (v << 8) | p[i];
+        return v;
+    }
+    static float decode(const uint8_t* p, uint32_t bits, bool isFloat) {
+        if (isFloat) {
+            if (bits == 32) { float f; std::memcpy(&f, p, 4); return f; }
+            double d; std::memcpy(&d, p, 8); return float(d);
+        }
+        switch (bits) {
+        case 16: return float(int16_t(le(p, 2))) * (1.0f / 32768.0f);
+        case 24: return float(int32_t(le(p, 3) << 8) >> 8) * (1.0f / 8388608.0f);
+        default: return float(int32_t(le(p, 4))) * (1.0f / 2147483648.0f);
+        }
+    }
+};
+
+// One impulse response at one rate: its partition spectra, the delay lines
+// sized for them and, if it is longer than the head, the worker thread that
+// convolves its tail. Built whole off the audio thread; never resized.
+class Convolver {
+public:
+    static constexpr uint32_t kHeadBlock = 64;
+    static constexpr uint32_t kTailBlock = 1024;
+    static constexpr uint32_t kHeadLength = 3 * kTailBlock; // the tail starts here
+    static constexpr uint32_t kHeadParts = kHeadLength / kHeadBlock;
+    static constexpr float kMaxSeconds = 4.0f; // longer IRs are faded out and cut
+
+    // Resamples the IR to `rate` (linear), normalizes it to unit energy in the
+    // louder channel, transforms its partitions and starts the tail worker.
+    // An empty or silent IR gives a convolver that is never ready().
+    Convolver(const ImpulseResponse& ir, float rate) : headFft(sharedFft(kHeadBlock)), tailFft(sharedFft(kTailBlock)) {
+        if (ir.left.empty()) return;
+        const float tailSamples = std::max(kMaxSeconds * rate - float(kHeadLength), 0.0f);
+        const size_t maxTailParts = std::max<size_t>(1, size_t(std::ceil(tailSamples / float(kTailBlock))));
+        const double step = double(ir.sampleRate) / double(rate);
+        const size_t maxFrames = size_t(kHeadLength) + maxTailParts * kTailBlock;
+        const size_t frames = std::min(size_t(double(ir.left.size() - 1) / step) + 1, maxFrames);
+        std::vector<float> l(frames), r(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            const double pos = double(i) * step;
+            const size_t i0 = std::min(size_t(pos), ir.left.size() - 1);
+            const size_t i1 = std::min(i0 + 1, ir.left.size() - 1);
+            const float frac = float(pos - double(i0));
+            l[i] = ir.left[i0] + (ir.left[i1] - ir.left[i0]) * frac;
+            r[i] = ir.right[i0] + (ir.right[i1] - ir.right[i0]) * frac;
+        }
+        if (frames == maxFrames) {
+            // Cut: fade out over the last 10 ms instead of stopping dead
+            const size_t fade = std::min(frames, size_t(rate * 0.01f) + 1);
+            for (size_t i = 0; i < fade; ++i) {
+                const float g = float(i) / float(fade);
+                l[frames - 1 - i] *= g;
+                r[frames - 1 - i] *= g;
+            }
+        }
+        double energyL = 0.0, energyR = 0.0;
+        for (size_t i = 0; i < frames; ++i) { energyL += double(l[i]) * l[i]; energyR += double(r[i]) * r[i]; }
+        const double energy = std::max(energyL, energyR);
+        if (energy <= 0.0) return;
+        const float gain = float(1.0 / std::sqrt(energy));
+
+        std::vector<Complex> work(2 * kTailBlock);
+        auto partition = [&](const Fft<float>& fft, float* out, size_t start, uint32_t block) {
+            std::fill(work.begin(), work.begin() + 2 * block, Complex{});
+            for (uint32_t j = 0; j < block && start + j < frames; ++j)
+                work[j] = Complex(l[start + j] * gain, r[start + j] * gain);
+            fft.forward(work.data());
+            toPlanar(work.data(), out, 2 * block);
+        };
+        headParts = uint32_t(std::min<size_t>(kHeadParts, (frames + kHeadBlock - 1) / kHeadBlock));
+        headSpectra.resize(size_t(headParts) * 4 * kHeadBlock);
+        for (uint32_t k = 0; k < headParts; ++k)
+            partition(headFft, headSpectra.data() + size_t(k) * 4 * kHeadBlock, size_t(k) * kHeadBlock, kHeadBlock);
+        headFdl.assign(headSpectra.size(), 0.0f);
+        if (frames <= kHeadLength) return;
+        tailParts = uint32_t((frames - kHeadLength + kTailBlock - 1) / kTailBlock);
+        tailSpectra.resize(size_t(tailParts) * 4 * kTailBlock);
+        for (uint32_t k = 0; k < tailParts; ++k)
+            partition(tailFft, tailSpectra.data() + size_t(k) * 4 * kTailBlock, kHeadLength + size_t(k) * kTailBlock,
+                      kTailBlock);
+        tailFdl.assign(tailSpectra.size(), 0.0f);
+        tailOut.assign(size_t(kSlots) * kTailBlock, {});
+        tailWork.assign(2 * kTailBlock, {});
+        tailSum.assign(4 * kTailBlock, 0.0f);
+        window.assign(2 * kTailBlock, 0.0f);
+        chunks.reset(new ChunkRing());
+        for (auto& chunk : slotChunk) chunk.store(kNoChunk);
+        worker = std::thread([this] { workerLoop(); });
+    }
+
+    ~Convolver() {
+        if (!worker.joinable()) return;
+        quit.store(true);
+        signal.post();
+        worker.join();
+    }
+    Convolver(const Convolver&) = delete;
+    Convolver& operator=(const Convolver&) = delete;
+
+    bool ready() const { return headParts > 0; }
+
+    // Audio thread. The wet signal is the mono send convolved with the stereo IR,
+    // delayed by kHeadBlock samples.
+    void process(float* left, float* right, uint32_t n, float mix) {
+        const float dry = 1.0f - mix;
+        for (uint32_t i = 0; i < n; ++i) {
+            filling.samples[inputPos & kInputMask] = 0.5f * (left[i] + right[i]);
+            ++inputPos;
+            const Complex wet = headOut[outPos];
+            left[i] = left[i] * dry + wet.real() * mix;
+            right[i] = right[i] * dry + wet.imag() * mix;
+            if (++outPos == kHeadBlock) {
+                outPos = 0;
+                renderBlock();
+            }
+        }
+    }
+
+    // Everything the audio thread and the worker touch
+    void registerMemory(DspMemory& memory) const {
+        memory.add(this, sizeof(*this));
+        memory.addVector(headSpectra);
+        memory.addVector(headFdl);
+        if (tailParts == 0) return;
+        memory.add(chunks.get(), sizeof(ChunkRing));
+        memory.addVector(tailSpectra);
+        memory.addVector(tailOut);
+        memory.addVector(tailFdl);
+        memory.addVector(tailWork);
+        memory.addVector(tailSum);
+        memory.addVector(window);
+    }
+
+private:
+    using Complex = std::complex<float>;
+    static constexpr uint32_t kInputMask = kTailBlock - 1;
+    static constexpr uint32_t kSlots = 4;
+    static constexpr uint32_t kNoSlot = kSlots;
+    static constexpr uint64_t kNoChunk = ~uint64_t(0);
+
+    // Tail block `index` of the send: samples (index - 1) * kTailBlock up to
+    // index * kTailBlock
+    struct TailChunk {
+        uint64_t index = 0;
+        float samples[kTailBlock] = {};
+    };
+    // Covers a worker six blocks late; past that, blocks are dropped
+    using ChunkRing = SpscRing<TailChunk, 8>;
+
+    // Overlap-save: transform the 2 * block samples of `ring` up to `end` into
+    // the delay line slot, then sum every partition against its input
+    // spectrum. The result is left in work; its second half is the output block.
+    // Spectra (here and in the delay lines) are planar, all real parts then
+    // all imaginary parts, so the multiply-add loops vectorize.
+    static void convolve(const Fft<float>& fft, const float* ring, uint32_t mask, uint64_t end, uint32_t block,
+                         float* fdl, uint32_t slot, const float* spectra, uint32_t parts, Complex* work, float* sum) {
+        const uint32_t bins = 2 * block;
+        for (uint32_t j = 0; j < bins; ++j) work[j] = Complex(ring[(end - bins + j) & mask], 0.0f);
+        fft.forward(work);
+        toPlanar(work, fdl + size_t(slot) * 2 * bins, bins);
+        float* sumRe = sum;
+        float* sumIm = sum + bins;
+        std::fill(sum, sum + 2 * bins, 0.0f);
+        for (uint32_t k = 0; k < parts; ++k) {
+            const float* xRe = fdl + size_t((slot + parts - k) % parts) * 2 * bins;
+            const float* xIm = xRe + bins;
+            const float* hRe = spectra + size_t(k) * 2 * bins;
+            const float* hIm = hRe + bins;
+            for (uint32_t j = 0; j < bins; ++j) {
+                sumRe[j] += xRe[j] * hRe[j] - xIm[j] * hIm[j];
+                sumIm[j] += xRe[j] * hIm[j] + xIm[j] * hRe[j];
+            }
+        }
+        for (uint32_t j = 0; j < bins; ++j) work[j] = Complex(sumRe[j], sumIm[j]);
+        fft.inverse(work);
+    }
+
+    static void toPlanar(const Complex* in, float* out, uint32_t bins) {
+        for (uint32_t j = 0; j < bins; ++j) {
+            out[j] = in[j].real();
+            out[bins + j] = in[j].imag();
+        }
+    }
+
+    // Audio thread, every kHeadBlock samples
+    void renderBlock() {
+        convolve(headFft, filling.samples, kInputMask, inputPos, kHeadBlock, headFdl.data(), headPos,
+                 headSpectra.data(), headParts, headWork, headSum);
+        headPos = (headPos + 1) % headParts;
+        std::copy(headWork + kHeadBlock, headWork + 2 * kHeadBlock, headOut);
+        if (playSlot != kNoSlot) {
+            const Complex* tail = tailOut.data() + size_t(playSlot) * kTailBlock + tailReadPos;
+            for (uint32_t j = 0; j < kHeadBlock; ++j) headOut[j] += tail[j];
+        }
+        tailReadPos += kHeadBlock;
+        if (tailParts == 0 || inputPos % kTailBlock != 0) return;
+        // Tail block boundary: chunk q - 2 covers the next kTailBlock samples
+        const uint64_t q = inputPos / kTailBlock;
+        tailReadPos = 0;
+        playSlot = kNoSlot;
+        if (q >= 2) {
+            const uint32_t slot = uint32_t((q - 2) % kSlots);
+            // Pairs with the worker's check in finishChunk(): either it sees
+            // this chunk is playing, or we see its slot is being rewritten
+            playingChunk.store(q - 2);
+            if (slotChunk[slot].load() == q - 2) playSlot = slot;
+        }
+        // The ring holds blocks the worker has not taken yet; a full one drops q
+        filling.index = q;
+        chunks->push(filling);
+        posted.store(q, std::memory_order_release);
+        signal.post();
+    }
+
+    void workerLoop() {
+        TailChunk chunk;
+        for (;;) {
+            signal.wait();
+            if (quit.load()) return;
+            while (chunks->pop(chunk)) convolveTail(chunk);
+        }
+    }
+
+    // Worker thread: the next chunk, with the previous one kept in window
+    void convolveTail(const TailChunk& chunk) {
+        const uint64_t c = chunk.index;
+        if (c != nextChunk) {
+            // The ring dropped chunks: their partitions, and the overlap, are silent
+            for (uint64_t m = nextChunk; m < c && m < nextChunk + tailParts; ++m)
+                std::fill_n(tailFdl.data() + size_t(m % tailParts) * 4 * kTailBlock, 4 * kTailBlock, 0.0f);
+            std::fill(window.begin(), window.begin() + kTailBlock, 0.0f);
+        }
+        nextChunk = c + 1;
+        std::copy(chunk.samples, chunk.samples + kTailBlock, window.begin() + kTailBlock);
+        convolve(tailFft, window.data(), 2 * kTailBlock - 1, 2 * kTailBlock, kTailBlock, tailFdl.data(),
+                 uint32_t(c % tailParts), tailSpectra.data(), tailParts, tailWork.data(), tailSum.data());
+        std::copy(window.begin() + kTailBlock, window.end(), window.begin());
+        finishChunk(c);
+    }
+
+    // Worker thread: publish chunk c's output unless it is too late to be heard
+    void finishChunk(uint64_t c) {
+        // Too late once the audio thread has reached chunk c + 2
+        if (posted.load(std::memory_order_acquire) >= c + 2) return;
+        const uint32_t slot = uint32_t(c % kSlots);
+        slotChunk[slot].store(kNoChunk);
+        const uint64_t playing = playingChunk.load();
+        if (playing != kNoChunk && playing % kSlots == slot) return;
+        std::copy(tailWork.begin() + kTailBlock, tailWork.end(), tailOut.begin() + size_t(slot) * kTailBlock);
+        slotChunk[slot].store(c, std::memory_order_release);
+    }
+
+    // The tables only depend on the size, so every instance shares one
+    // read-only pair, built by the first instance rather than each constructor
+    static const Fft<float>& sharedFft(uint32_t block) {
+        static const Fft<float> head(2 * kHeadBlock), tail(2 * kTailBlock);
+        return block == kHeadBlock ? head : tail;
+    }
+
+    const Fft<float>& headFft;
+    const Fft<float>& tailFft;
+    uint32_t headParts = 0, tailParts = 0;
+    std::vector<float> headSpectra, tailSpectra;
+
+    // Audio thread; `filling` is the send's ring, and the chunk handed over
+    TailChunk filling;
+    uint64_t inputPos = 0;
+    std::vector<float> headFdl;
+    Complex headWork[2 * kHeadBlock];
+    float headSum[4 * kHeadBlock];
+    Complex headOut[kHeadBlock] = {};
+    uint32_t outPos = 0, headPos = 0, tailReadPos = 0, playSlot = kNoSlot;
+
+    // Handoff between the audio thread and the worker
+    std::unique_ptr<ChunkRing> chunks;     // input blocks, audio thread to worker
+    std::atomic<uint64_t> posted{0};       // newest chunk handed over
+    std::atomic<uint64_t> playingChunk{kNoChunk};
+    std::atomic<uint64_t> slotChunk[kSlots];
+    std::vector<Complex> tailOut;          // kSlots blocks of tail output
+
+    // Worker thread
+    std::vector<float> tailFdl, tailSum;
+    std::vector<float> window;             // the previous chunk, then the current one
+    std::vector<Complex> tailWork;
+    uint64_t nextChunk = 1;
+    WorkerSignal signal;
+    std::thread worker;
+    std::atomic<bool> quit{false};
+};
+
+// The convolver of the loaded IR and its handover to the audio thread
+class ConvolutionReverb {
+public:
+    ~ConvolutionReverb() { stop(); }
+
+    // Builds the loaded IR, if any, for this rate. Called from activate(),
+    // never from the audio thread.
+    void prepare(float sampleRate) {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        release();
+        rate = sampleRate;
+        if (!impulse.left.empty()) live = new Convolver(impulse, rate);
+        active = true;
+    }
+
+    // Frees the convolver and stops its worker; called from deactivate()
+    void stop() {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        release();
+        active = false;
+    }
+
+    // Off the audio thread. An empty path unloads the IR. Returns false if the
+    // file can't be decoded (the current IR stays). While active, the new
+    // convolver is built here and offered; the audio thread takes it at its
+    // next block. Nothing waits for that: a later load replaces an offer not
+    // yet taken, and the convolver it replaced is freed by the next load,
+    // prepare() or stop().
+    bool loadFile(const char* path) {
+        ImpulseResponse ir;
+        if (path && *path && !ir.load(path)) return false;
+        std::lock_guard<std::mutex> lock(loadMutex);
+        impulse = std::move(ir);
+        if (!active) return true; // built by the next prepare()
+        collect();
+        delete offered.exchange(new Convolver(impulse, rate), std::memory_order_acq_rel);
+        return true;
+    }
+
+    // Audio thread, once per block whether or not process() runs: swaps in a
+    // newly loaded IR and returns whether one is ready
+    bool impulseReady() {
+        if (offered.load(std::memory_order_acquire) && (!live || retired.push(live)))
+            live = offered.exchange(nullptr, std::memory_order_acq_rel);
+        return live && live->ready();
+    }
+
+    // Audio thread, after impulseReady() returned true
+    void process(float* left, float* right, uint32_t n, float mix) { live->process(left, right, n, mix); }
+
+    // Only the convolver that exists, if any
+    void registerMemory(DspMemory& memory) const {
+        if (live) live->registerMemory(memory);
+    }
+
+private:
+    // Frees convolvers the audio thread has handed back
+    void collect() {
+        Convolver* old;
+        while (retired.pop(old)) delete old;
+    }
+
+    // Everything, while the audio thread is stopped
+    void release() {
+        collect();
+        delete offered.exchange(nullptr);
+        delete live;
+        live = nullptr;
+    }
+
+    float rate = 48000.0f;
+    Convolver* live = nullptr;                 // the audio thread's
+    std::atomic<Convolver*> offered{nullptr};  // built by a load, not yet taken
+    SpscRing<Convolver*, 4> retired;           // taken over, to be freed by the loader
+
+    // Loader (host threads), serialized with prepare() and stop()
+    std::mutex loadMutex;
+    ImpulseResponse impulse;
+    bool active = false;
+};
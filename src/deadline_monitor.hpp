@@ -0,0 +1,94 @@
+// deadline_monitor.hpp - Measures each run() against its real-time budget
+// Load = block wall time / (frames / sampleRate). 1.0 means the block used its
+// whole deadline; anything above that is an xrun on a single-core host.
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+class DeadlineMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Histogram of load in 1/128 steps up to 2.0; the last bucket catches overruns
+    static constexpr int kBuckets = 256;
+    static constexpr float kBucketsPerUnit = 128.0f;
+    // Stats are republished every kPublishBlocks blocks and the histogram is
+    // halved every kDecayPublishes publishes so old blocks fade out.
+    static constexpr int kPublishBlocks = 32;
+    static constexpr int kDecayPublishes = 16;
+
+    void setThreshold(float t) { threshold = t; }
+
+    // Audio thread, once per run(). Returns the block's load.
+    float endBlock(Clock::time_point start, uint32_t frames, float sampleRate) {
+        if (frames == 0 || sampleRate <= 0.0f) return 0.0f;
+        const float elapsed = std::chrono::duration<float>(Clock::now() - start).count();
+        const float load = elapsed * sampleRate / float(frames);
+        int b = int(load * kBucketsPerUnit);
+        if (b >= kBuckets) b = kBuckets - 1;
+        ++histogram[b];
+        ++histogramTotal;
+        if (load > periodMax) periodMax = load;
+        if (load >= threshold)
+            nearMisses.store(nearMisses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (++blocksSincePublish >= kPublishBlocks) publish();
+        return load;
+    }
+
+    void reset() {
+        for (int b = 0; b < kBuckets; ++b) histogram[b] = 0;
+        histogramTotal = 0;
+        blocksSincePublish = publishes = 0;
+        periodMax = lastPeriodMax = 0.0f;
+        p50.store(0.0f, std::memory_order_relaxed);
+        p99.store(0.0f, std::memory_order_relaxed);
+        maxLoad.store(0.0f, std::memory_order_relaxed);
+        nearMisses.store(0, std::memory_order_relaxed);
+    }
+
+    // Any thread
+    float getP50() const { return p50.load(std::memory_order_relaxed); }
+    float getP99() const { return p99.load(std::memory_order_relaxed); }
+    float getMax() const { return maxLoad.load(std::memory_order_relaxed); }
+    uint32_t getNearMisses() const { return nearMisses.load(std::memory_order_relaxed); }
+
+private:
+    void publish() {
+        blocksSincePublish = 0;
+        p50.store(percentile(0.50f), std::memory_order_relaxed);
+        p99.store(percentile(0.99f), std::memory_order_relaxed);
+        maxLoad.store(periodMax > lastPeriodMax ? periodMax : lastPeriodMax, std::memory_order_relaxed);
+        if (++publishes >= kDecayPublishes) {
+            publishes = 0;
+            histogramTotal = 0;
+            for (int b = 0; b < kBuckets; ++b) {
+                histogram[b] >>= 1;
+                histogramTotal += histogram[b];
+            }
+            lastPeriodMax = periodMax;
+            periodMax = 0.0f;
+        }
+    }
+
+    // Upper edge of the bucket holding the q-th quantile
+    float percentile(float q) const {
+        if (histogramTotal == 0) return 0.0f;
+        const uint32_t rank = uint32_t(q * float(histogramTotal - 1));
+        uint32_t seen = 0;
+        for (int b = 0; b < kBuckets; ++b) {
+            seen += histogram[b];
+            if (seen > rank) return float(b + 1) / kBucketsPerUnit;
+        }
+        return float(kBuckets) / kBucketsPerUnit;
+    }
+
+    float threshold = 0.8f;
+    uint32_t histogram[kBuckets] = {};
+    uint32_t histogramTotal = 0;
+    int blocksSincePublish = 0;
+    int publishes = 0;
+    float periodMax = 0.0f, lastPeriodMax = 0.0f;
+    std::atomic<float> p50{0.0f}, p99{0.0f}, maxLoad{0.0f};
+    std::atomic<uint32_t> nearMisses{0};
+};
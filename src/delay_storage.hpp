@@ -0,0 +1,105 @@
+// delay_storage.hpp - Sample formats for long delay lines
+// Delay lines are bandwidth-bound: every sample is written once and read back
+// a second later, long after it left the cache. Storing 16 bits per sample
+// halves that traffic (and the footprint per instance). Picked at build time:
+//   make DELAY_STORAGE=half   IEEE fp16 (F16C instructions when the build
+//                             targets them, portable bit arithmetic otherwise)
+//   make DELAY_STORAGE=int16  fixed point with 12 dB headroom and TPDF dither
+// The default keeps full 32-bit floats.
+#pragma once
+#include <cstdint>
+#include <cstring>
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+struct FloatStorage {
+    using Sample = float;
+    Sample encode(float x) { return x; }
+    static float decode(Sample s) { return s; }
+};
+
+// Relative error 2^-11 at most: one pass adds about -97 dBFS to a -20 dBFS
+// signal, falling with it. Values past the fp16 range saturate instead of
+// becoming infinities.
+struct HalfStorage {
+    using Sample = uint16_t;
+    static constexpr float kMax = 65504.0f;
+
+    Sample encode(float x) {
+        x = x > kMax ? kMax : (x < -kMax ? -kMax : x);
+#if defined(__F16C__)
+        return Sample(_cvtss_sh(x, _MM_FROUND_TO_NEAREST_INT));
+#else
+        uint32_t f;
+        std::memcpy(&f, &x, sizeof f);
+        const uint32_t sign = (f >> 16) & 0x8000u;
+        f &= 0x7fffffffu;
+        if (f < 0x38800000u) {
+            // fp16 subnormal or zero: let the FPU round the mantissa
+            float a;
+            std::memcpy(&a, &f, sizeof a);
+            return Sample(sign | uint32_t(a * 16777216.0f + 0.5f));
+        }
+        // Round to nearest even on the 13 dropped mantissa bits, then rebias
+        f += 0x0fffu + ((f >> 13) & 1u);
+        return Sample(sign | ((f - 0x38000000u) >> 13));
+#endif
+    }
+
+    static float decode(Sample h) {
+#if defined(__F16C__)
+        return _cvtsh_ss(h);
+#else
+        const uint32_t sign = uint32_t(h & 0x8000u) << 16;
+        const uint32_t rest = h & 0x7fffu;
+        float out;
+        if (rest < 0x0400u) {
+            out = float(rest) * (1.0f / 16777216.0f); // subnormal: rest * 2^-24
+        } else {
+            const uint32_t f = (rest << 13) + 0x38000000u;
+            std::memcpy(&out, &f, sizeof out);
+        }
+        uint32_t bits;
+        std::memcpy(&bits, &out, sizeof bits);
+        bits |= sign;
+        std::memcpy(&out, &bits, sizeof out);
+        return out;
+#endif
+    }
+};
+
+// +-4.0 full scale. TPDF dither decorrelates the rounding error from the
+// signal, so each pass through the line adds a flat noise floor of -84 dBFS
+// instead of distortion on quiet tails.
+struct Int16Storage {
+    using Sample = int16_t;
+    static constexpr float kFullScale = 4.0f;
+    static constexpr float kScale = 32767.0f / kFullScale;
+
+    Sample encode(float x) {
+        const float dither = (uniform() + uniform()) - 1.0f; // +-1 LSB, triangular
+        float v = x * kScale + dither;
+        v = v > 32767.0f ? 32767.0f : (v < -32768.0f ? -32768.0f : v);
+        return Sample(int32_t(v + (v >= 0.0f ? 0.5f : -0.5f)));
+    }
+    static float decode(Sample s) { return float(s) * (1.0f / kScale); }
+
+private:
+    // 0..1, xorshift32
+    float uniform() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return float(state >> 8) * (1.0f / 16777216.0f);
+    }
+    uint32_t state = 0x9e3779b9u;
+};
+
+#if defined(SYNTH_DELAY_HALF)
+using DelayStorage = HalfStorage;
+#elif defined(SYNTH_DELAY_INT16)
+using DelayStorage = Int16Storage;
+#else
+using DelayStorage = FloatStorage;
+#endif
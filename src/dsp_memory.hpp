@@ -0,0 +1,95 @@
+// dsp_memory.hpp - Prefault (and optionally lock) memory the audio thread uses
+// activate() registers every buffer run() touches; each page is written once
+// so the first block after load never takes a page fault. Builds with
+// SYNTH_MLOCK (make MLOCK=true) additionally pin the pages with mlock().
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+class DspMemory {
+public:
+    static constexpr int kMaxRegions = 32;
+
+    ~DspMemory() { release(); }
+
+    // Touch every page of the region and lock it if enabled. Call outside the
+    // audio thread. Regions past kMaxRegions are still prefaulted, not locked.
+    void add(const void* ptr, size_t bytes) {
+        if (!ptr || bytes == 0) return;
+        prefault(ptr, bytes);
+#ifdef SYNTH_MLOCK
+        if (count < kMaxRegions && lockRegion(ptr, bytes)) {
+            regions[count].ptr = ptr;
+            regions[count].bytes = bytes;
+            ++count;
+            locked += bytes;
+        }
+#endif
+        prefaulted += bytes;
+    }
+
+    template <typename Vector>
+    void addVector(const Vector& v) { add(v.data(), v.size() * sizeof(v[0])); }
+
+    // Unlock everything registered so far
+    void release() {
+        for (int i = 0; i < count; ++i) unlockRegion(regions[i].ptr, regions[i].bytes);
+        count = 0;
+        locked = prefaulted = 0;
+    }
+
+    size_t lockedBytes() const { return locked; }
+    size_t prefaultedBytes() const { return prefaulted; }
+
+private:
+    static size_t pageSize() {
+#if defined(__unix__) || defined(__APPLE__)
+        static const size_t size = size_t(sysconf(_SC_PAGESIZE));
+        return size;
+#else
+        return 4096;
+#endif
+    }
+
+    // Read-modify-write one byte per page: faults the page in as writable
+    // without changing its contents.
+    static void prefault(const void* ptr, size_t bytes) {
+        volatile unsigned char* p = static_cast<volatile unsigned char*>(const_cast<void*>(ptr));
+        const size_t page = pageSize();
+        for (size_t off = 0; off < bytes; off += page) p[off] = p[off];
+        p[bytes - 1] = p[bytes - 1];
+    }
+
+    static bool lockRegion(const void* ptr, size_t bytes) {
+#if defined(_WIN32)
+        return VirtualLock(const_cast<void*>(ptr), bytes) != 0;
+#elif defined(__unix__) || defined(__APPLE__)
+        return mlock(ptr, bytes) == 0;
+#else
+        (void)ptr; (void)bytes;
+        return false;
+#endif
+    }
+
+    static void unlockRegion(const void* ptr, size_t bytes) {
+#if defined(_WIN32)
+        VirtualUnlock(const_cast<void*>(ptr), bytes);
+#elif defined(__unix__) || defined(__APPLE__)
+        munlock(ptr, bytes);
+#else
+        (void)ptr; (void)bytes;
+#endif
+    }
+
+    struct Region { const void* ptr; size_t bytes; };
+    Region regions[kMaxRegions] = {};
+    int count = 0;
+    size_t locked = 0;
+    size_t prefaulted = 0;
+};
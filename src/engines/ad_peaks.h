@@ -1,24 +1,29 @@
 // Faithful Mutable Instruments Peaks AD envelope clone
 #pragma once
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include "envelope_ramp.h"
 
 class PeaksAD {
 public:
-    void setSampleRate(float sr) { sampleRate = sr; }
-    void setAttack(float a) { attack = a; calcRates(); }
-    void setDecay(float d) { decay = d; calcRates(); }
-    void gateOn() { state = ATTACK; }
-    void gateOff() { state = IDLE; }
-    void reset() { state = IDLE; env = 0.0f; }
+    PeaksAD() { calcRates(); }
+    // Rates are only recomputed when an input actually changes
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; calcRates(); } }
+    void setAttack(float a) { if (a != attack) { attack = a; calcRates(); } }
+    void setDecay(float d) { if (d != decay) { decay = d; calcRates(); } }
+    void gateOn() { begin(ATTACK); }
+    void gateOff() { begin(IDLE); }
+    void reset() { env = 0.0f; begin(IDLE); }
     float process() {
         switch (state) {
             case ATTACK:
-                env += attackRate;
-                if (env >= 1.0f) { env = 1.0f; state = DECAY; }
+                env = rampValue(segStart, attackRate, ++segPos);
+                if (env >= 1.0f) { env = 1.0f; begin(DECAY); }
                 break;
             case DECAY:
-                env -= decayRate;
-                if (env <= 0.0f) { env = 0.0f; state = IDLE; }
+                env = rampValue(segStart, -decayRate, ++segPos);
+                if (env <= 0.0f) { env = 0.0f; begin(IDLE); }
                 break;
             case IDLE:
             default:
@@ -27,6 +32,30 @@ public:
         }
         return env;
     }
+    // Same samples as n calls to process(), filled a segment at a time
+    void processBlock(float* out, uint32_t n) {
+        uint32_t i = 0;
+        while (i < n) {
+            float slope = 0.0f, target = 0.0f;
+            switch (state) {
+                case ATTACK: slope = attackRate; target = 1.0f; break;
+                case DECAY: slope = -decayRate; target = 0.0f; break;
+                case IDLE:
+                default:
+                    env = 0.0f;
+                    std::fill(out + i, out + n, 0.0f);
+                    return;
+            }
+            const uint32_t count = rampSamplesLeft(segStart, slope, target, segPos, n - i);
+            if (count > 0) {
+                fillRamp(out + i, count, segStart, slope, segPos);
+                segPos += int(count);
+                env = out[i + count - 1];
+                i += count;
+            }
+            if (i < n) out[i++] = process();
+        }
+    }
 private:
     enum State { IDLE, ATTACK, DECAY };
     State state = IDLE;
@@ -34,8 +63,14 @@ private:
     float attack = 0.01f, decay = 0.1f;
     float attackRate = 0.0f, decayRate = 0.0f;
     float env = 0.0f;
+    // The current segment is segStart + slope * segPos
+    float segStart = 0.0f;
+    int segPos = 0;
+    void begin(State s) { state = s; segStart = env; segPos = 0; }
     void calcRates() {
         attackRate = (attack > 0.0001f) ? 1.0f / (attack * sampleRate) : 1.0f;
         decayRate = (decay > 0.0001f) ? 1.0f / (decay * sampleRate) : 1.0f;
+        // New rates continue from the current level
+        begin(state);
     }
 };
@@ -1,14 +1,19 @@
 // additive_engine.h
 #pragma once
 #include <cmath>
+#include <cstdint>
+#include "oversampler.h"
 
 
 class AdditiveEngine {
 public:
-    void setSampleRate(float sr) { sampleRate = sr; }
-    void setFrequency(float freq) { frequency = freq; }
-    void setHarmonics(float h) { harmonics = h; }
-    void setTimbre(float t) { timbre = t; }
+    static constexpr const char* kName = "Additive";
+    static constexpr bool kRandomStart = true; // reset() draws random phases
+    // Setters only flag the partial table; it is rebuilt on the next sample
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; coeffsDirty = true; } }
+    void setFrequency(float freq) { if (freq != frequency) { frequency = freq; coeffsDirty = true; } }
+    void setHarmonics(float h) { if (h != harmonics) { harmonics = h; coeffsDirty = true; } }
+    void setTimbre(float t) { if (t != timbre) { timbre = t; coeffsDirty = true; } }
     void setMorph(float m) { morph = m; }
     void setLevel(float l) { level = l; }
     void setLfoFreq(float f) { lfoFreq = f; }
@@ -16,33 +21,33 @@ public:
     void setLfoVar(float v) { lfoVar = v; }
     void setADSR(float a, float d, float s, float r) { attack = a; decay = d; sustain = s; release = r; }
     void gate(bool g) { gateOn = g; }
-    void reset() { for (int i=0; i<16; ++i) { phases[i] = 0.0f; phaseOffsets[i] = ((float)rand()/RAND_MAX); } }
+    void reset() { for (int i=0; i<16; ++i) { phases[i] = 0.0f; phaseOffsets[i] = ((float)rand()/RAND_MAX); } saturator.reset(); }
     // Stereo output (identical L/R)
-    void process(float& left, float& right) {
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
     // Gate ignored: always output sound
-        float l = processMono();
-        left = l * level;
-        right = l * level;
+        for (uint32_t i = 0; i < n; ++i) left[i] = oscillate() * 1.1f;
+        saturator.process(left, n, [](float x) { return std::tanh(x); });
+        for (uint32_t i = 0; i < n; ++i) {
+            float noise = ((float)rand() / RAND_MAX - 0.5f) * 0.006f;
+            left[i] = (left[i] + noise) * 0.7f * level;
+            right[i] = left[i];
+        }
     }
-    // Mono process (for internal use)
-    float processMono() {
+    void setOversampling(int factor) { saturator.setFactor(factor); }
+    // One sample before the output saturation
+    float oscillate() {
+        if (coeffsDirty) updateCoeffs();
         float out = 0.0f;
-        int numHarm = 2 + int(harmonics * 14.0f);
         for (int i=0; i<numHarm; ++i) {
-            float amp = 1.0f / std::pow(i+1, 1.0f + 0.7f * timbre);
             float env = 1.0f - morph * std::abs(std::sin(M_PI * phases[i]));
-            float detune = 1.0f + 0.001f * (i - numHarm/2) * (0.5f + 0.5f * timbre);
-            float freqMul = float(i+1) * detune;
-            float phaseInc = frequency * freqMul / sampleRate;
-            phases[i] += phaseInc;
+            phases[i] += phaseIncs[i];
             if (phases[i] >= 1.0f) phases[i] -= 1.0f;
             float ph = phases[i] + phaseOffsets[i];
             if (ph >= 1.0f) ph -= 1.0f;
-            out += amp * env * std::sin(2.0f * M_PI * ph);
+            out += amps[i] * env * std::sin(2.0f * M_PI * ph);
         }
-        float noise = ((float)rand() / RAND_MAX - 0.5f) * 0.006f;
-        out = std::tanh(out * 1.1f) + noise;
-        return out * 0.7f;
+        return out;
     }
     // Parameter getters
     float getSampleRate() const { return sampleRate; }
@@ -57,6 +62,16 @@ public:
     void getADSR(float& a, float& d, float& s, float& r) const { a = attack; d = decay; s = sustain; r = release; }
     bool isGateOn() const { return gateOn; }
 private:
+    void updateCoeffs() {
+        numHarm = 2 + int(harmonics * 14.0f);
+        for (int i=0; i<numHarm; ++i) {
+            amps[i] = 1.0f / std::pow(i+1, 1.0f + 0.7f * timbre);
+            float detune = 1.0f + 0.001f * (i - numHarm/2) * (0.5f + 0.5f * timbre);
+            float freqMul = float(i+1) * detune;
+            phaseIncs[i] = frequency * freqMul / sampleRate;
+        }
+        coeffsDirty = false;
+    }
     float sampleRate = 48000.0f;
     float frequency = 440.0f;
     float harmonics = 0.0f;
@@ -70,4 +85,10 @@ private:
     bool gateOn = false;
     float phases[16] = {0};
     float phaseOffsets[16] = {0};
+    // Derived from frequency/harmonics/timbre/sampleRate
+    bool coeffsDirty = true;
+    int numHarm = 2;
+    float amps[16] = {0};
+    float phaseIncs[16] = {0};
+    Oversampler saturator;
 };
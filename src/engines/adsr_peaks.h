@@ -1,35 +1,40 @@
 // Faithful Mutable Instruments Peaks ADSR/AD envelope clone
 #pragma once
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include "envelope_ramp.h"
 
 class PeaksADSR {
 public:
     enum Mode { ADSR, AD };
-    void setSampleRate(float sr) { sampleRate = sr; }
-    void setAttack(float a) { attack = a; calcRates(); }
-    void setDecay(float d) { decay = d; calcRates(); }
-    void setSustain(float s) { sustain = s; }
-    void setRelease(float r) { release = r; calcRates(); }
+    PeaksADSR() { calcRates(); }
+    // Rates are only recomputed when an input actually changes
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; calcRates(); } }
+    void setAttack(float a) { if (a != attack) { attack = a; calcRates(); } }
+    void setDecay(float d) { if (d != decay) { decay = d; calcRates(); } }
+    void setSustain(float s) { if (s != sustain) { sustain = s; calcRates(); } }
+    void setRelease(float r) { if (r != release) { release = r; calcRates(); } }
     void setMode(Mode m) { mode = m; }
-    void gateOn() { state = ATTACK; }
-    void gateOff() { if (mode == ADSR) state = RELEASE; else state = IDLE; }
-    void reset() { state = IDLE; env = 0.0f; }
+    void gateOn() { begin(ATTACK); }
+    void gateOff() { begin(mode == ADSR ? RELEASE : IDLE); }
+    void reset() { env = 0.0f; begin(IDLE); }
     float process() {
         switch (state) {
             case ATTACK:
-                env += attackRate;
-                if (env >= 1.0f) { env = 1.0f; state = DECAY; }
+                env = rampValue(segStart, attackRate, ++segPos);
+                if (env >= 1.0f) { env = 1.0f; begin(DECAY); }
                 break;
             case DECAY:
-                env -= decayRate;
-                if (env <= sustain || mode == AD) { env = sustain; state = (mode == ADSR) ? SUSTAIN : RELEASE; }
+                env = rampValue(segStart, -decayRate, ++segPos);
+                if (env <= sustain || mode == AD) { env = sustain; begin((mode == ADSR) ? SUSTAIN : RELEASE); }
                 break;
             case SUSTAIN:
                 // Hold
                 break;
             case RELEASE:
-                env -= releaseRate;
-                if (env <= 0.0f) { env = 0.0f; state = IDLE; }
+                env = rampValue(segStart, -releaseRate, ++segPos);
+                if (env <= 0.0f) { env = 0.0f; begin(IDLE); }
                 break;
             case IDLE:
             default:
@@ -38,6 +43,34 @@ public:
         }
         return env;
     }
+    // Same samples as n calls to process(); runs inside a segment are filled
+    // as ramps and the state machine only handles the sample that ends one
+    void processBlock(float* out, uint32_t n) {
+        uint32_t i = 0;
+        while (i < n) {
+            float slope = 0.0f, target = 0.0f;
+            switch (state) {
+                case ATTACK: slope = attackRate; target = 1.0f; break;
+                // In AD mode decay always ends on its first sample
+                case DECAY: slope = -decayRate; target = mode == AD ? 2.0f : sustain; break;
+                case RELEASE: slope = -releaseRate; target = 0.0f; break;
+                case SUSTAIN:
+                case IDLE:
+                default:
+                    if (state != SUSTAIN) env = 0.0f;
+                    std::fill(out + i, out + n, env);
+                    return;
+            }
+            const uint32_t count = rampSamplesLeft(segStart, slope, target, segPos, n - i);
+            if (count > 0) {
+                fillRamp(out + i, count, segStart, slope, segPos);
+                segPos += int(count);
+                env = out[i + count - 1];
+                i += count;
+            }
+            if (i < n) out[i++] = process();
+        }
+    }
 private:
     enum State { IDLE, ATTACK, DECAY, SUSTAIN, RELEASE };
     State state = IDLE;
@@ -46,9 +79,15 @@ private:
     float attack = 0.01f, decay = 0.1f, sustain = 0.7f, release = 0.2f;
     float attackRate = 0.0f, decayRate = 0.0f, releaseRate = 0.0f;
     float env = 0.0f;
+    // The current segment is segStart + slope * segPos
+    float segStart = 0.0f;
+    int segPos = 0;
+    void begin(State s) { state = s; segStart = env; segPos = 0; }
     void calcRates() {
         attackRate = (attack > 0.0001f) ? 1.0f / (attack * sampleRate) : 1.0f;
         decayRate = (decay > 0.0001f) ? (1.0f - sustain) / (decay * sampleRate) : 1.0f;
         releaseRate = (release > 0.0001f) ? sustain / (release * sampleRate) : 1.0f;
+        // New rates continue from the current level
+        begin(state);
     }
 };
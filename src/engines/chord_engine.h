@@ -1,31 +1,67 @@
 // chord_engine.h
 #pragma once
 #include <cmath>
+#include <cstdint>
+#include "oversampler.h"
 
 
 class ChordEngine {
 public:
-    void setSampleRate(float sr) { sampleRate = sr; }
-    void setFrequency(float freq) { frequency = freq; }
-    void setHarmonics(float h) { harmonics = h; }
-    void setTimbre(float t) { timbre = t; }
-    void setMorph(float m) { morph = m; }
+    static constexpr const char* kName = "Chord";
+    static constexpr bool kRandomStart = true; // reset() draws random phases
+    // Setters only flag the per-voice coefficients; they are rebuilt on the next sample
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; coeffsDirty = true; } }
+    void setFrequency(float freq) { if (freq != frequency) { frequency = freq; coeffsDirty = true; } }
+    void setHarmonics(float h) { if (h != harmonics) { harmonics = h; coeffsDirty = true; } }
+    void setTimbre(float t) { if (t != timbre) { timbre = t; coeffsDirty = true; } }
+    void setMorph(float m) { if (m != morph) { morph = m; coeffsDirty = true; } }
     void setLevel(float l) { level = l; }
     void setLfoFreq(float f) { lfoFreq = f; }
     void setLfoWave(float w) { lfoWave = w; }
     void setLfoVar(float v) { lfoVar = v; }
     void setADSR(float a, float d, float s, float r) { attack = a; decay = d; sustain = s; release = r; }
     void gate(bool g) { gateOn = g; }
-    void reset() { for (int i=0; i<4; ++i) { phases[i] = 0.0f; phaseOffsets[i] = ((float)rand()/RAND_MAX); } }
+    void reset() { for (int i=0; i<4; ++i) { phases[i] = 0.0f; phaseOffsets[i] = ((float)rand()/RAND_MAX); } saturator.reset(); }
     // Stereo output (identical L/R)
-    void process(float& left, float& right) {
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
     // Gate ignored: always output sound
-        float l = processMono();
-        left = l * level;
-        right = l * level;
+        for (uint32_t i = 0; i < n; ++i) left[i] = oscillate() * 1.1f;
+        saturator.process(left, n, [](float x) { return std::tanh(x); });
+        for (uint32_t i = 0; i < n; ++i) {
+            float noise = ((float)rand() / RAND_MAX - 0.5f) * 0.006f;
+            left[i] = (left[i] + noise) * 0.25f * level;
+            right[i] = left[i];
+        }
+    }
+    void setOversampling(int factor) { saturator.setFactor(factor); }
+    // One sample before the output saturation
+    float oscillate() {
+        if (coeffsDirty) updateCoeffs();
+        float out = 0.0f;
+        for (int i=0; i<4; ++i) {
+            phases[i] += phaseIncs[i];
+            if (phases[i] >= 1.0f) phases[i] -= 1.0f;
+            float ph = phases[i] + phaseOffsets[i];
+            if (ph >= 1.0f) ph -= 1.0f;
+            out += amps[i] * std::sin(2.0f * M_PI * ph);
+        }
+        return out;
     }
-    // Mono process (for internal use)
-    float processMono() {
+    // Parameter getters
+    float getSampleRate() const { return sampleRate; }
+    float getFrequency() const { return frequency; }
+    float getHarmonics() const { return harmonics; }
+    float getTimbre() const { return timbre; }
+    float getMorph() const { return morph; }
+    float getLevel() const { return level; }
+    float getLfoFreq() const { return lfoFreq; }
+    float getLfoWave() const { return lfoWave; }
+    float getLfoVar() const { return lfoVar; }
+    void getADSR(float& a, float& d, float& s, float& r) const { a = attack; d = decay; s = sustain; r = release; }
+    bool isGateOn() const { return gateOn; }
+private:
+    void updateCoeffs() {
         static const float chordTable[8][4] = {
             {0.0f, 4.0f, 7.0f, 12.0f},
             {0.0f, 3.0f, 7.0f, 10.0f},
@@ -44,34 +80,13 @@ public:
         for (int i=0; i<4; ++i) {
             intervals[i] = chordTable[c0][i] * (1.0f-frac) + chordTable[c1][i] * frac;
         }
-        float out = 0.0f;
         for (int i=0; i<4; ++i) {
             float detune = 1.0f + (timbre-0.5f) * 0.03f * i;
-            float phaseInc = frequency * std::pow(2.0f, intervals[i]/12.0f) * detune / sampleRate;
-            phases[i] += phaseInc;
-            if (phases[i] >= 1.0f) phases[i] -= 1.0f;
-            float ph = phases[i] + phaseOffsets[i];
-            if (ph >= 1.0f) ph -= 1.0f;
-            float amp = 0.6f + 0.4f * std::sin(2.0f * M_PI * (morph + i*0.25f));
-            out += amp * std::sin(2.0f * M_PI * ph);
+            phaseIncs[i] = frequency * std::pow(2.0f, intervals[i]/12.0f) * detune / sampleRate;
+            amps[i] = 0.6f + 0.4f * std::sin(2.0f * M_PI * (morph + i*0.25f));
         }
-        float noise = ((float)rand() / RAND_MAX - 0.5f) * 0.006f;
-        out = std::tanh(out * 1.1f) + noise;
-        return out * 0.25f;
+        coeffsDirty = false;
     }
-    // Parameter getters
-    float getSampleRate() const { return sampleRate; }
-    float getFrequency() const { return frequency; }
-    float getHarmonics() const { return harmonics; }
-    float getTimbre() const { return timbre; }
-    float getMorph() const { return morph; }
-    float getLevel() const { return level; }
-    float getLfoFreq() const { return lfoFreq; }
-    float getLfoWave() const { return lfoWave; }
-    float getLfoVar() const { return lfoVar; }
-    void getADSR(float& a, float& d, float& s, float& r) const { a = attack; d = decay; s = sustain; r = release; }
-    bool isGateOn() const { return gateOn; }
-private:
     float sampleRate = 48000.0f;
     float frequency = 440.0f;
     float harmonics = 0.0f;
@@ -84,5 +99,10 @@ private:
     float attack = 0.01f, decay = 0.1f, sustain = 0.8f, release = 0.2f;
     bool gateOn = false;
     float phases[4] = {0};
+    // Derived from frequency/harmonics/timbre/morph/sampleRate
+    bool coeffsDirty = true;
+    float phaseIncs[4] = {0};
+    float amps[4] = {0};
     float phaseOffsets[4] = {0};
+    Oversampler saturator;
 };
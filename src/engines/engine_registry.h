@@ -0,0 +1,262 @@
+// engine_registry.h - Compile-time registry of the synthesis engines
+// The engine list below is the only place an engine has to be added. Names,
+// the Engine parameter range and the per-block dispatch tables are generated
+// from it; dispatch happens once per block through a function-pointer table
+// and the per-sample loop inside each entry is fully inlined for its engine.
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "sine_engine.h"
+#include "triangle_engine.h"
+#include "square_engine.h"
+#include "saw_engine.h"
+#include "supersaw_engine.h"
+#include "faithful_virtual_analog_engine.h"
+#include "fm_engine.h"
+#include "formant_engine.h"
+#include "additive_engine.h"
+#include "chord_engine.h"
+#include "string_engine.h"
+#include "pwm_engine.h"
+#include "modal_engine.h"
+#include "wavefolder_engine.h"
+#include "granular_engine.h"
+#include "string_bank_engine.h"
+#include "unison.h"
+
+// Shared macro controls pushed into the selected engine
+struct EngineControls {
+    float sampleRate;
+    float frequency;
+    float harmonics;
+    float timbre;
+    float morph;
+    int oversampling; // 1, 2, 4 or 8: rate of the engine's output saturation
+    int unison;       // stacked copies, clamped to what the engine's slot share allows
+    float unisonDetune;
+};
+
+template <typename... Engines>
+struct EngineList {};
+
+// Every entry is played through the unison wrapper
+template <typename E>
+using Stacked = Unison<E, unisonVoices<E>()>;
+
+template <typename List>
+class EngineRegistry;
+
+template <typename... Engines>
+class EngineRegistry<EngineList<Engines...>> {
+public:
+    static constexpr int kCount = int(sizeof...(Engines));
+    static constexpr std::size_t kSlotSize = std::max({ sizeof(Stacked<Engines>)... });
+
+    // Preallocated storage for exactly one engine, sized for the largest one.
+    // Only the selected engine is ever constructed, so the deselected engines
+    // cost neither memory nor cache footprint. Delay lines and rings, whose
+    // length depends on the rate, live in a pool beside the slot that
+    // prepare() sizes for the largest engine at the current rate.
+    class Slot {
+    public:
+        Slot() = default;
+        ~Slot() { release(); }
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+
+        // Size the pool for sampleRate and zero it; call off the audio
+        // thread. The selected engine is rebuilt on the new pool.
+        void prepare(float sampleRate) {
+            minBlepTable(); // built here, never on the audio thread
+            const int index = selected();
+            release();
+            rate = sampleRate;
+            pool.assign((std::max({ Stacked<Engines>::bufferSize(sampleRate)... }) + 15) / 16, Line{});
+            clean = pool.size() * 16;
+            pending = index;
+            advance();
+        }
+
+        // Switch to engine `index`; safe on the audio thread. The old engine
+        // is destroyed now, the new one is constructed in place (no heap
+        // allocation) at a later render, once the part of the pool it uses
+        // has been cleared, kClearStep floats per render. Returns false if
+        // it was already selected.
+        bool select(int index) {
+            if (index == selected()) return false;
+            release();
+            pending = index;
+            return true;
+        }
+        void release() {
+            if (live >= 0) {
+                // Its buffers are dirty now; a pool of zeros stays clean
+                if (kBufferSize[live](rate) > 0) clean = 0;
+                kDestroy[live](storage);
+            }
+            live = pending = -1;
+            triggered = false;
+        }
+        // The live engine, -1 while none is or while the next one waits
+        int index() const { return live; }
+        int selected() const { return pending >= 0 ? pending : live; }
+        void* get() { return storage; }
+        float* buffer() { return pool.empty() ? nullptr : pool.front().v; }
+        std::size_t bufferBytes() const { return pool.size() * sizeof(Line); }
+
+    private:
+        friend class EngineRegistry;
+        struct alignas(64) Line { float v[16]; };
+        // 32 KiB per render, a couple of microseconds: a String Bank or
+        // Granular ring is clear after 2 renders at 48 kHz, 8 at 192 kHz
+        static constexpr std::size_t kClearStep = 8192;
+
+        // Clear the next step of the pending engine's buffers and construct
+        // it once they are all zero. True if an engine is live afterwards.
+        bool advance() {
+            if (pending < 0) return live >= 0;
+            const std::size_t floats = kBufferSize[pending](rate);
+            if (floats > pool.size() * 16) return false; // prepare() not called yet
+            if (clean < floats) {
+                const std::size_t step = std::min(floats - clean, kClearStep);
+                std::fill(buffer() + clean, buffer() + clean + step, 0.0f);
+                clean += step;
+                if (clean < floats) return false;
+            }
+            kConstruct[pending](storage, buffer(), rate);
+            live = pending;
+            pending = -1;
+            // Controls and a note-on that arrived while it was pending
+            if (hasControls) kUpdate[live](storage, controls);
+            if (triggered) kTrigger[live](storage);
+            triggered = false;
+            return true;
+        }
+
+        alignas(Stacked<Engines>...) unsigned char storage[kSlotSize];
+        int live = -1;
+        int pending = -1;
+        float rate = 48000.0f;
+        std::vector<Line> pool;
+        std::size_t clean = 0; // floats from the start of the pool known to be zero
+        EngineControls controls = {};
+        bool hasControls = false;
+        bool triggered = false;
+    };
+
+    static constexpr const char* kNames[kCount] = { Engines::kName... };
+
+    static const char* name(int index) { return kNames[clampIndex(index)]; }
+
+    static int clampIndex(int index) {
+        return index < 0 ? 0 : (index >= kCount ? kCount - 1 : index);
+    }
+
+    // Render n samples of the live engine (at unity level) into left/right
+    static void render(Slot& slot, float* left, float* right, uint32_t n) {
+        if (!slot.advance()) {
+            std::fill(left, left + n, 0.0f);
+            std::fill(right, right + n, 0.0f);
+            return;
+        }
+        kRender[slot.index()](slot.get(), left, right, n);
+    }
+
+    // Kept for an engine that is still pending
+    static void update(Slot& slot, const EngineControls& c) {
+        slot.controls = c;
+        slot.hasControls = true;
+        if (slot.index() >= 0) kUpdate[slot.index()](slot.get(), c);
+    }
+
+    static void reset(Slot& slot) {
+        if (slot.index() >= 0) kReset[slot.index()](slot.get());
+    }
+
+    // Note on; a no-op for engines without trigger()
+    static void trigger(Slot& slot) {
+        if (slot.index() >= 0) kTrigger[slot.index()](slot.get());
+        else slot.triggered = slot.pending >= 0;
+    }
+
+private:
+    using ConstructFn = void (*)(void*, float*, float);
+    using BufferSizeFn = std::size_t (*)(float);
+    using DestroyFn = void (*)(void*);
+    using RenderFn = void (*)(void*, float*, float*, uint32_t);
+    using UpdateFn = void (*)(void*, const EngineControls&);
+    using ResetFn = void (*)(void*);
+    using TriggerFn = void (*)(void*);
+
+    template <typename E>
+    static void constructEngine(void* storage, float* buffer, float sampleRate) {
+        (new (storage) E())->setBuffer(buffer, sampleRate);
+    }
+
+    template <typename E>
+    static void destroyEngine(void* storage) { static_cast<E*>(storage)->~E(); }
+
+    template <typename E>
+    static void renderEngine(void* storage, float* left, float* right, uint32_t n) {
+        E& engine = *static_cast<E*>(storage);
+        if constexpr (HasProcessBlock<E>::value) {
+            engine.processBlock(left, right, n);
+        } else {
+            for (uint32_t i = 0; i < n; ++i) engine.process(left[i], right[i]);
+        }
+    }
+
+    template <typename E>
+    static void updateEngine(void* storage, const EngineControls& c) {
+        E& engine = *static_cast<E*>(storage);
+        engine.setSampleRate(c.sampleRate);
+        engine.setFrequency(c.frequency);
+        engine.setHarmonics(c.harmonics);
+        engine.setTimbre(c.timbre);
+        engine.setMorph(c.morph);
+        if constexpr (HasOversampling<E>::value) engine.setOversampling(c.oversampling);
+        engine.setUnison(c.unison, c.unisonDetune);
+    }
+
+    template <typename E>
+    static void resetEngine(void* storage) { static_cast<E*>(storage)->reset(); }
+
+    template <typename E>
+    static void triggerEngine(void* storage) {
+        if constexpr (HasTrigger<E>::value) static_cast<E*>(storage)->trigger();
+    }
+
+    static constexpr ConstructFn kConstruct[kCount] = { &constructEngine<Stacked<Engines>>... };
+    static constexpr BufferSizeFn kBufferSize[kCount] = { &Stacked<Engines>::bufferSize... };
+    static constexpr DestroyFn kDestroy[kCount] = { &destroyEngine<Stacked<Engines>>... };
+    static constexpr RenderFn kRender[kCount] = { &renderEngine<Stacked<Engines>>... };
+    static constexpr UpdateFn kUpdate[kCount] = { &updateEngine<Stacked<Engines>>... };
+    static constexpr ResetFn kReset[kCount] = { &resetEngine<Stacked<Engines>>... };
+    static constexpr TriggerFn kTrigger[kCount] = { &triggerEngine<Stacked<Engines>>... };
+};
+
+// Order defines the Engine parameter values; append new engines at the end
+using SynthEngines = EngineRegistry<EngineList<
+    SineEngine,                  // 0
+    TriangleEngine,              // 1
+    SquareEngine,                // 2
+    SawEngine,                   // 3
+    SuperSawEngine,              // 4
+    FaithfulVirtualAnalogEngine, // 5
+    FMEngine,                    // 6
+    FormantEngine,               // 7
+    AdditiveEngine,              // 8
+    ChordEngine,                 // 9
+    StringEngine,                // 10
+    PWMEngine,                   // 11
+    ModalEngine,                 // 12
+    WavefolderEngine,            // 13
+    GranularEngine,              // 14
+    StringBankEngine             // 15
+>>;
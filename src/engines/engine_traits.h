@@ -0,0 +1,45 @@
+// engine_traits.h - Optional engine capabilities, detected at compile time
+// The registry and the unison wrapper only call what an engine provides.
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Engines that render whole blocks expose processBlock(left, right, n)
+template <typename E, typename = void>
+struct HasProcessBlock : std::false_type {};
+
+template <typename E>
+struct HasProcessBlock<E, std::void_t<decltype(std::declval<E&>().processBlock(
+    std::declval<float*>(), std::declval<float*>(), uint32_t(0)))>> : std::true_type {};
+
+// Engines with an oversampled nonlinear stage expose setOversampling(factor)
+template <typename E, typename = void>
+struct HasOversampling : std::false_type {};
+
+template <typename E>
+struct HasOversampling<E, std::void_t<decltype(std::declval<E&>().setOversampling(0))>> : std::true_type {};
+
+// Engines whose exciter restarts on each note expose trigger()
+template <typename E, typename = void>
+struct HasTrigger : std::false_type {};
+
+template <typename E>
+struct HasTrigger<E, std::void_t<decltype(std::declval<E&>().trigger())>> : std::true_type {};
+
+// Engines with delay lines or rings as long as a time in seconds take their
+// storage from the registry: bufferSize(sampleRate) floats, zeroed, handed
+// over by setBuffer(memory, sampleRate) before the first render
+template <typename E, typename = void>
+struct HasBuffer : std::false_type {};
+
+template <typename E>
+struct HasBuffer<E, std::void_t<decltype(E::bufferSize(0.0f))>> : std::true_type {};
+
+// Engines whose copies never start alike, because reset() draws random phases
+// or the exciter is noise, declare kRandomStart = true
+template <typename E, typename = void>
+struct HasRandomStart : std::false_type {};
+
+template <typename E>
+struct HasRandomStart<E, std::void_t<decltype(E::kRandomStart)>> : std::bool_constant<E::kRandomStart> {};
@@ -0,0 +1,33 @@
+// envelope_ramp.h - Closed-form linear envelope segments
+// A segment's value is computed from its start level and sample count rather
+// than accumulated, so the per-sample and block paths produce the same floats
+// and a block inside one segment is a plain vectorizable ramp.
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+// Value of a linear segment k samples after it started
+inline float rampValue(float start, float slope, int k) { return start + slope * float(k); }
+
+// Samples after `pos` that stay strictly inside a segment ending at the first
+// value at or past `target` (above it when rising, below when falling), capped
+// at `limit`.
+inline uint32_t rampSamplesLeft(float start, float slope, float target, int pos, uint32_t limit) {
+    const auto reached = [&](int64_t k) {
+        const float v = rampValue(start, slope, int(k));
+        return slope > 0.0f ? v >= target : v <= target;
+    };
+    const int64_t first = int64_t(pos) + 1, last = first + int64_t(limit);
+    if (slope == 0.0f) return reached(first) ? 0 : limit;
+    // Estimate the ending sample, then settle it against the exact float test
+    const double estimate = std::ceil(double(target - start) / double(slope));
+    int64_t end = estimate < double(first) ? first : (estimate > double(last) ? last : int64_t(estimate));
+    while (end > first && reached(end - 1)) --end;
+    while (end < last && !reached(end)) ++end;
+    return uint32_t(end - first);
+}
+
+// Fill out[0, count) with the segment's samples pos+1 .. pos+count
+inline void fillRamp(float* out, uint32_t count, float start, float slope, int pos) {
+    for (uint32_t i = 0; i < count; ++i) out[i] = start + slope * float(pos + 1 + int(i));
+}
@@ -0,0 +1,55 @@
+// exciter.h - Pluck/bow/strike excitation shared by the physical-model engines
+// model picks the gesture in thirds (pluck, bow, strike); position stretches
+// the pluck and strike bursts. Free running (the String engine's behavior),
+// a finished pluck starts over at once; otherwise each burst plays once per
+// trigger(). The bow is continuous either way.
+#pragma once
+#include <cstdlib>
+#include "rate_scale.h"
+
+class StringExciter {
+public:
+    void setFreeRunning(bool f) { freeRunning = f; }
+    void trigger() { phase = 0.0f; }
+    void reset() { phase = 0.0f; bowLP = 0.0f; }
+    // The bow feeds energy continuously instead of in one burst
+    static bool isBow(float model) { return model >= 0.33f && model < 0.66f; }
+
+    float process(float model, float position, float sampleRate) {
+        float exc = 0.0f;
+        if (model < 0.33f) {
+            // Pluck: short burst of noise
+            if (phase < 1.0f) {
+                exc = noise() * 2.0f * (1.0f - phase);
+                phase += 1.0f / (sampleRate * 0.002f + position * 0.02f * sampleRate);
+            }
+        } else if (isBow(model)) {
+            // Bow: continuous noise with lowpass
+            exc = noise() * 0.4f;
+            if (sampleRate != bowRate) {
+                bowRate = sampleRate;
+                bowCoef = rateCoef(0.96f, sampleRate);
+                bowIn = 1.0f - bowCoef;
+            }
+            bowLP = bowLP * bowCoef + exc * bowIn;
+            exc = bowLP;
+        } else {
+            // Strike: short, sharp burst
+            if (phase < 0.5f) {
+                exc = noise() * 3.0f * (1.0f - 2.0f * phase);
+                phase += 1.0f / (sampleRate * 0.001f + position * 0.01f * sampleRate);
+            }
+        }
+        if (freeRunning && phase > 1.0f) phase = 0.0f;
+        return exc;
+    }
+
+private:
+    static float noise() { return (float)rand() / RAND_MAX - 0.5f; }
+
+    float phase = 0.0f;
+    float bowLP = 0.0f;
+    // Bow lowpass, recomputed when the caller's rate changes
+    float bowRate = kReferenceRate, bowCoef = 0.96f, bowIn = 0.04f;
+    bool freeRunning = true;
+};
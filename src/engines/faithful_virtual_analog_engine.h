@@ -2,60 +2,59 @@
 #pragma once
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include "minblep.h"
+#include "oversampler.h"
 
-// Faithful Plaits-style Virtual Analog Engine: dual oscillator, musical detune, morphable shape, pulse width, etc.
+// Faithful Plaits-style Virtual Analog Engine: dual minBLEP oscillator, musical detune, morphable shape, pulse width,
+// osc 2 hard-synced to osc 1 (harmonics sweeps the sync interval)
 inline float clampf(float x, float a, float b) { return x < a ? a : (x > b ? b : x); }
 
 class FaithfulVirtualAnalogEngine {
 public:
-    void setSampleRate(float sr) { sampleRate = sr; }
-    void setFrequency(float freq) { frequency = freq; }
-    void setHarmonics(float h) { harmonics = h; }
-    void setTimbre(float t) { timbre = t; }
-    void setMorph(float m) { morph = m; }
+    static constexpr const char* kName = "Virtual Analog";
+    FaithfulVirtualAnalogEngine() { osc2.reset(0.25f); }
+    // Setters only flag the oscillator coefficients; they are rebuilt on the next sample
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; coeffsDirty = true; } }
+    void setFrequency(float freq) { if (freq != frequency) { frequency = freq; coeffsDirty = true; } }
+    void setHarmonics(float h) { if (h != harmonics) { harmonics = h; coeffsDirty = true; } }
+    void setTimbre(float t) { if (t != timbre) { timbre = t; coeffsDirty = true; } }
+    void setMorph(float m) { if (m != morph) { morph = m; coeffsDirty = true; } }
     void setLevel(float l) { level = l; }
     void setLfoFreq(float f) { lfoFreq = f; }
     void setLfoWave(float w) { lfoWave = w; }
     void setLfoVar(float v) { lfoVar = v; }
     void setADSR(float a, float d, float s, float r) { attack = a; decay = d; sustain = s; release = r; }
     void gate(bool g) { gateOn = g; }
-    void reset() { phase1 = 0.0f; phase2 = 0.25f; }
+    void reset() {
+        osc1.reset(0.0f); osc2.reset(0.25f);
+        blepL.reset(); blepR.reset();
+        saturatorL.reset(); saturatorR.reset();
+    }
+    void setOversampling(int factor) { saturatorL.setFactor(factor); saturatorR.setFactor(factor); }
     // Stereo output
-    void process(float& left, float& right) {
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
     // Gate ignored: always output sound
-        static const float intervals[5] = {0.0f, 7.01f, 12.01f, 19.01f, 24.01f};
-        float detune = harmonics * 4.0f;
-        int idx = int(detune);
-        float frac = detune - idx;
-        float interval = intervals[idx] + (intervals[std::min(idx+1,4)] - intervals[idx]) * frac;
-        float freq2 = frequency * std::pow(2.0f, interval / 12.0f);
-        float shape1 = timbre * 1.5f;
-        shape1 = clampf(shape1, 0.0f, 1.0f);
-        float pw1 = 0.5f + (timbre - 0.66f) * 1.4f;
-        pw1 = clampf(pw1, 0.5f, 0.99f);
-        float shape2 = morph * 1.5f;
-        shape2 = clampf(shape2, 0.0f, 1.0f);
-        float pw2 = 0.5f + (morph - 0.66f) * 1.4f;
-        pw2 = clampf(pw2, 0.5f, 0.99f);
-        float inc1 = frequency / sampleRate;
-        phase1 += inc1;
-        if (phase1 >= 1.0f) phase1 -= 1.0f;
-        float saw1 = 2.0f * (phase1 - 0.5f);
-        float square1 = (phase1 < pw1 ? 1.0f : -1.0f);
-        float out1 = (1.0f-shape1) * saw1 + shape1 * square1;
-        float inc2 = freq2 / sampleRate;
-        phase2 += inc2;
-        if (phase2 >= 1.0f) phase2 -= 1.0f;
-        float saw2 = 2.0f * (phase2 - 0.5f);
-        float square2 = (phase2 < pw2 ? 1.0f : -1.0f);
-        float out2 = (1.0f-shape2) * saw2 + shape2 * square2;
-    // float out = 0.5f * (out1 + out2); // Removed unused variable
-        left = out1 * level;
-        right = out2 * level;
-        left += ((float)rand() / RAND_MAX - 0.5f) * 0.002f;
-        right += ((float)rand() / RAND_MAX - 0.5f) * 0.002f;
-        left = std::tanh(left * 0.8f);
-        right = std::tanh(right * 0.8f);
+        if (coeffsDirty) updateCoeffs();
+        while (n > 0) {
+            const int count = int(std::min<uint32_t>(n, BlepBuffer::kMaxBlock));
+            for (int i = 0; i < count; ++i) {
+                left[i] = osc1.process(inc1, blepL, i);
+                right[i] = osc2.processSynced(inc2, osc1.lastWrap(), blepR, i);
+            }
+            blepL.apply(left, count);
+            blepR.apply(right, count);
+            for (int i = 0; i < count; ++i) {
+                left[i] = (left[i] * level + ((float)rand() / RAND_MAX - 0.5f) * 0.002f) * 0.8f;
+                right[i] = (right[i] * level + ((float)rand() / RAND_MAX - 0.5f) * 0.002f) * 0.8f;
+            }
+            saturatorL.process(left, uint32_t(count), [](float x) { return std::tanh(x); });
+            saturatorR.process(right, uint32_t(count), [](float x) { return std::tanh(x); });
+            left += count;
+            right += count;
+            n -= uint32_t(count);
+        }
     }
     // Parameter getters
     float getSampleRate() const { return sampleRate; }
@@ -70,6 +69,25 @@ public:
     void getADSR(float& a, float& d, float& s, float& r) const { a = attack; d = decay; s = sustain; r = release; }
     bool isGateOn() const { return gateOn; }
 private:
+    void updateCoeffs() {
+        static const float intervals[5] = {0.0f, 7.01f, 12.01f, 19.01f, 24.01f};
+        float detune = harmonics * 4.0f;
+        int idx = int(detune);
+        float frac = detune - idx;
+        float interval = intervals[idx] + (intervals[std::min(idx+1,4)] - intervals[idx]) * frac;
+        float freq2 = frequency * std::pow(2.0f, interval / 12.0f);
+        shape1 = clampf(timbre * 1.5f, 0.0f, 1.0f);
+        pw1 = clampf(0.5f + (timbre - 0.66f) * 1.4f, 0.5f, 0.99f);
+        shape2 = clampf(morph * 1.5f, 0.0f, 1.0f);
+        pw2 = clampf(0.5f + (morph - 0.66f) * 1.4f, 0.5f, 0.99f);
+        inc1 = frequency / sampleRate;
+        inc2 = freq2 / sampleRate;
+        osc1.setShape(1.0f - shape1, shape1, 0.0f);
+        osc1.setPulseWidth(pw1);
+        osc2.setShape(1.0f - shape2, shape2, 0.0f);
+        osc2.setPulseWidth(pw2);
+        coeffsDirty = false;
+    }
     float sampleRate = 48000.0f;
     float frequency = 440.0f;
     float harmonics = 0.5f;
@@ -81,6 +99,11 @@ private:
     float lfoVar = 0.0f;
     float attack = 0.01f, decay = 0.1f, sustain = 0.8f, release = 0.2f;
     bool gateOn = false;
-    float phase1 = 0.0f;
-    float phase2 = 0.25f;
+    BlepOscillator osc1, osc2;
+    BlepBuffer blepL, blepR;
+    Oversampler saturatorL, saturatorR;
+    // Derived from frequency/harmonics/timbre/morph/sampleRate
+    bool coeffsDirty = true;
+    float inc1 = 0.0f, inc2 = 0.0f;
+    float shape1 = 0.0f, pw1 = 0.5f, shape2 = 0.0f, pw2 = 0.5f;
 };
@@ -0,0 +1,65 @@
+// fft.h - Radix-2 complex FFT
+// Twiddles and the bit-reversal permutation are built by the constructor (which
+// allocates); forward() and inverse() are in place and allocation-free.
+#pragma once
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class Fft {
+public:
+    // size must be a power of two
+    explicit Fft(size_t size) : n(size), twiddles(size / 2), bitrev(size, 0) {
+        const double w = -2.0 * M_PI / double(n);
+        for (size_t k = 0; k < n / 2; ++k)
+            twiddles[k] = std::complex<T>(T(std::cos(w * double(k))), T(std::sin(w * double(k))));
+        size_t bits = 0;
+        while ((size_t(1) << bits) < n) ++bits;
+        for (size_t i = 0; i < n; ++i) {
+            size_t r = 0;
+            for (size_t b = 0; b < bits; ++b)
+                if (i & (size_t(1) << b)) r |= size_t(1) << (bits - 1 - b);
+            bitrev[i] = r;
+        }
+    }
+
+    size_t size() const { return n; }
+
+    void forward(std::complex<T>* x) const { transform(x, T(1)); }
+
+    // Inverse transform, scaled by 1/size
+    void inverse(std::complex<T>* x) const {
+        transform(x, T(-1));
+        const T scale = T(1) / T(n);
+        for (size_t i = 0; i < n; ++i) x[i] *= scale;
+    }
+
+private:
+    void transform(std::complex<T>* x, T sign) const {
+        for (size_t i = 0; i < n; ++i)
+            if (i < bitrev[i]) std::swap(x[i], x[bitrev[i]]);
+        for (size_t len = 2; len <= n; len <<= 1) {
+            const size_t half = len / 2;
+            const size_t stride = n / len;
+            for (size_t start = 0; start < n; start += len) {
+                for (size_t k = 0; k < half; ++k) {
+                    // Written out to avoid the NaN-checking complex multiply
+                    const T wr = twiddles[k * stride].real();
+                    const T wi = sign * twiddles[k * stride].imag();
+                    const std::complex<T> a = x[start + k];
+                    const std::complex<T> b = x[start + k + half];
+                    const std::complex<T> bw(b.real() * wr - b.imag() * wi, b.real() * wi + b.imag() * wr);
+                    x[start + k] = a + bw;
+                    x[start + k + half] = a - bw;
+                }
+            }
+        }
+    }
+
+    size_t n;
+    std::vector<std::complex<T>> twiddles;
+    std::vector<size_t> bitrev;
+};
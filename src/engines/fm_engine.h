@@ -1,11 +1,13 @@
 // fm_engine.h
 #pragma once
 #include <cmath>
+#include "rate_scale.h"
 
 
 class FMEngine {
 public:
-    void setSampleRate(float sr) { sampleRate = sr; }
+    static constexpr const char* kName = "FM/Phase Mod";
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; envCoef = rateCoef(0.9995f, sr); } }
     void setFrequency(float freq) { frequency = freq; }
     void setHarmonics(float h) { harmonics = h; }
     void setTimbre(float t) { timbre = t; }
@@ -37,7 +39,7 @@ public:
         if (phaseM >= 1.0f) phaseM -= 1.0f;
         float mod = std::sin(2.0f * M_PI * (phaseM + feedback * lastOut));
         float shaper = mod - 0.2f * std::pow(mod,3);
-        env *= 0.9995f;
+        env *= envCoef;
         if (env < 0.05f) env = 1.0f;
         float idx = modIndex * env;
         float out = std::sin(2.0f * M_PI * phaseC + idx * shaper);
@@ -73,4 +75,5 @@ private:
     float phaseC = 0.0f, phaseM = 0.0f;
     float lastOut = 0.0f;
     float env = 1.0f;
+    float envCoef = 0.9995f;
 };
@@ -0,0 +1,247 @@
+// granular_engine.h
+// Granular texture engine. A source engine renders continuously into a ring
+// (the capture buffer) and a cloud of short windowed grains replays it at
+// scattered delays, pitches and pan positions:
+//   harmonics: density, 1 to 32 overlapping grains
+//   timbre:    grain size, 5 ms to 100 ms
+//   morph:     spray: delay and pan scatter, then detune up to +-30 cents,
+//              and past the middle a growing share of grains an octave away
+// Grains come from a fixed pool; scheduling runs once per block and the only
+// per-sample work is each live grain's ring read and window lookup, followed by
+// a vectorized multiply-add into the output. Nothing is allocated: the pool
+// lives inside the engine and the ring is storage the registry hands over,
+// sized for the host rate.
+// Granular<Source> captures any engine with processBlock(); GranularEngine
+// uses a plain minBLEP saw/triangle oscillator.
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "minblep.h"
+#include "rate_scale.h"
+
+// Hann window shared by every grain, built during static initialization
+class GrainWindowTable {
+public:
+    static constexpr int kSize = 1024;
+    GrainWindowTable() {
+        for (int i = 0; i <= kSize; ++i) table[i] = 0.5f - 0.5f * std::cos(2.0f * float(M_PI) * float(i) / kSize);
+        table[kSize + 1] = 0.0f; // guard for the interpolation at the very end
+    }
+    float table[kSize + 2];
+};
+
+inline const GrainWindowTable grainWindowTable;
+
+// Internal source: band-limited saw/triangle blend at the note frequency
+class GrainOscillator {
+public:
+    GrainOscillator() { osc.setShape(0.6f, 0.0f, 0.4f); }
+    void setSampleRate(float sr) { sampleRate = sr; }
+    void setFrequency(float freq) { frequency = freq; }
+    void reset() { osc.reset(); blep.reset(); }
+    void processBlock(float* left, float* right, uint32_t n) {
+        const float inc = frequency / sampleRate;
+        for (uint32_t i = 0; i < n; ++i) left[i] = osc.process(inc, blep, int(i));
+        blep.apply(left, int(n));
+        std::copy(left, left + n, right);
+    }
+
+private:
+    BlepOscillator osc;
+    BlepBuffer blep;
+    float sampleRate = 48000.0f;
+    float frequency = 440.0f;
+};
+
+template <typename Source>
+class Granular {
+public:
+    static constexpr const char* kName = "Granular";
+    static constexpr int kMaxGrains = 128;
+    static constexpr int kBlock = 64;
+    static constexpr float kRingSeconds = 0.3f; // at least; 341 ms at 48 and 192 kHz
+
+    static constexpr std::size_t bufferSize(float sampleRate) { return ringFrames(kRingSeconds, sampleRate); }
+    void setBuffer(float* memory, float sampleRate) {
+        ring = memory;
+        ringSize = ringFrames(kRingSeconds, sampleRate);
+        ringMask = ringSize - 1;
+    }
+
+    void setSampleRate(float sr) { sampleRate = sr; source.setSampleRate(sr); }
+    void setFrequency(float freq) { source.setFrequency(freq); }
+    void setHarmonics(float h) { overlap = 1.0f + 31.0f * h * h; }
+    void setTimbre(float t) { grainSeconds = 0.005f * std::pow(20.0f, std::clamp(t, 0.0f, 1.0f)); }
+    void setMorph(float m) { spray = std::clamp(m, 0.0f, 1.0f); }
+    void setLevel(float l) { level = l; }
+    void reset() {
+        source.reset();
+        std::fill(ring, ring + ringSize, 0.0f);
+        writePos = 0;
+        liveGrains = 0;
+        untilNextGrain = 0.0f;
+    }
+
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
+        while (n > 0) {
+            const int count = int(std::min<uint32_t>(n, kBlock));
+            capture(left, right, count);
+            schedule(count);
+            std::fill(left, left + count, 0.0f);
+            std::fill(right, right + count, 0.0f);
+            // Scattered grains are uncorrelated and add up in power; without
+            // spray they play the same samples in phase and add up in amplitude
+            const float coherence = std::max(1.0f - 8.0f * spray, 0.0f);
+            const float norm = level * std::pow(overlap, -0.5f - 0.5f * coherence);
+            for (int g = 0; g < liveGrains;) {
+                const int end = renderGrain(g, count);
+                const float gl = grains.gainL[g] * norm, gr = grains.gainR[g] * norm;
+                for (int i = grains.start[g]; i < end; ++i) {
+                    left[i] += gl * grainOut[i];
+                    right[i] += gr * grainOut[i];
+                }
+                grains.start[g] = 0;
+                if (grains.window[g] >= float(GrainWindowTable::kSize)) retire(g);
+                else ++g;
+            }
+            left += count;
+            right += count;
+            n -= uint32_t(count);
+        }
+    }
+
+private:
+    // Grain pool as structure-of-arrays; live grains are kept packed at the front
+    struct Grains {
+        uint32_t readPos[kMaxGrains]; // ring index of the next read
+        float readFrac[kMaxGrains];
+        float rate[kMaxGrains];       // ring samples per output sample
+        float window[kMaxGrains];     // position in the window table
+        float windowInc[kMaxGrains];
+        float gainL[kMaxGrains], gainR[kMaxGrains];
+        int start[kMaxGrains];        // first sample of this block the grain plays
+    };
+
+    // Render the source into the ring; the output buffers serve as scratch
+    void capture(float* left, float* right, int count) {
+        source.processBlock(left, right, uint32_t(count));
+        for (int i = 0; i < count; ++i)
+            ring[(writePos + uint32_t(i)) & ringMask] = 0.5f * (left[i] + right[i]);
+        writePos = (writePos + uint32_t(count)) & ringMask;
+    }
+
+    // Start the grains due in this block at their exact sample offsets
+    void schedule(int count) {
+        // Capped so even an octave-up grain fits its head start in the ring
+        const float length = std::clamp(grainSeconds * sampleRate, 16.0f, float(ringSize / 2 - kBlock));
+        const float interval = length / overlap;
+        while (untilNextGrain < float(count)) {
+            spawn(int(untilNextGrain), count, length);
+            // Jittered spacing keeps the cloud from buzzing at the grain rate
+            untilNextGrain += interval * (1.0f + spray * (random() - 0.5f));
+        }
+        untilNextGrain -= float(count);
+    }
+
+    void spawn(int offset, int count, float length) {
+        if (liveGrains == kMaxGrains) return; // pool full: skip this grain
+        const int g = liveGrains++;
+        float cents = spray * 60.0f * (random() - 0.5f);
+        if (spray > 0.5f && random() < spray - 0.5f) cents += random() < 0.5f ? -1200.0f : 1200.0f;
+        const float rate = std::exp2(cents / 1200.0f);
+        // A faster grain must start far enough back not to overtake the write
+        // head; a slower one falls behind, and neither may lap the ring
+        const float catchUp = std::max(rate - 1.0f, 0.0f) * length;
+        const float fallBack = std::max(1.0f - rate, 0.0f) * length;
+        const float room = float(ringSize - 2 * kBlock) - fallBack;
+        const float delay = std::min(catchUp + 2.0f + spray * random() * 0.1f * sampleRate, room);
+        // The ring already holds this block; the write head sits at its end.
+        // Whole samples are counted in integers, so the fraction keeps full
+        // float precision however large the ring
+        const float back = std::ceil(delay);
+        grains.readPos[g] = (writePos - uint32_t(count) + uint32_t(offset) - uint32_t(back)) & ringMask;
+        grains.readFrac[g] = back - delay;
+        grains.rate[g] = rate;
+        grains.window[g] = 0.0f;
+        grains.windowInc[g] = float(GrainWindowTable::kSize) / length;
+        const float pan = 0.5f + 0.5f * spray * (2.0f * random() - 1.0f);
+        grains.gainL[g] = std::cos(0.5f * float(M_PI) * pan);
+        grains.gainR[g] = std::sin(0.5f * float(M_PI) * pan);
+        grains.start[g] = offset;
+    }
+
+    // Windowed samples of grain g into grainOut[start, end); returns end
+    int renderGrain(int g, int count) {
+        const int begin = grains.start[g];
+        const float rate = grains.rate[g], winc = grains.windowInc[g];
+        const float remaining = (float(GrainWindowTable::kSize) - grains.window[g]) / winc;
+        const int end = std::min(count, begin + int(std::ceil(remaining)));
+        const uint32_t base = grains.readPos[g];
+        const float frac0 = grains.readFrac[g], w0 = grains.window[g];
+        const float* table = grainWindowTable.table;
+        // Positions come from the start of the block, not a running sum, so
+        // iterations are independent
+        for (int i = begin; i < end; ++i) {
+            const float k = float(i - begin);
+            const float p = frac0 + rate * k;
+            const uint32_t ip = uint32_t(p);
+            const float fp = p - float(ip);
+            const float a = ring[(base + ip) & ringMask];
+            const float b = ring[(base + ip + 1) & ringMask];
+            const float w = std::min(w0 + winc * k, float(GrainWindowTable::kSize));
+            const int iw = int(w);
+            const float fw = w - float(iw);
+            const float win = table[iw] + fw * (table[iw + 1] - table[iw]);
+            grainOut[i] = win * (a + fp * (b - a));
+        }
+        const float steps = float(end - begin);
+        const float p = frac0 + rate * steps;
+        const uint32_t ip = uint32_t(p);
+        grains.readPos[g] = (base + ip) & ringMask;
+        grains.readFrac[g] = p - float(ip);
+        grains.window[g] = end < count ? float(GrainWindowTable::kSize) : w0 + winc * steps;
+        return end;
+    }
+
+    // Move the last live grain into slot g
+    void retire(int g) {
+        const int last = --liveGrains;
+        grains.readPos[g] = grains.readPos[last];
+        grains.readFrac[g] = grains.readFrac[last];
+        grains.rate[g] = grains.rate[last];
+        grains.window[g] = grains.window[last];
+        grains.windowInc[g] = grains.windowInc[last];
+        grains.gainL[g] = grains.gainL[last];
+        grains.gainR[g] = grains.gainR[last];
+        grains.start[g] = grains.start[last];
+    }
+
+    // 0..1, xorshift32
+    float random() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return float(rng >> 8) * (1.0f / 16777216.0f);
+    }
+
+    Source source;
+    float* ring = nullptr;
+    uint32_t ringSize = 0;
+    uint32_t ringMask = 0;
+    uint32_t writePos = 0;
+    Grains grains;
+    int liveGrains = 0;
+    alignas(16) float grainOut[kBlock];
+    float untilNextGrain = 0.0f;
+    float sampleRate = 48000.0f;
+    float overlap = 8.75f;
+    float grainSeconds = 0.022f;
+    float spray = 0.5f;
+    float level = 1.0f;
+    uint32_t rng = 0x9e3779b9u;
+};
+
+using GranularEngine = Granular<GrainOscillator>;
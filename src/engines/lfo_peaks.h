@@ -1,44 +1,86 @@
 // Faithful Mutable Instruments Peaks LFO clone
+// Rendered a block at a time: the phase of every sample is computed from the
+// block start, so each waveform is one branch-free loop. Between blocks the
+// phase is kept in double, so float rounding doesn't make the rate depend on
+// the block size. RANDOM draws from a counter-based generator keyed by the
+// cycle number alone. Each instance keeps its own counter, but the key is the
+// same everywhere on purpose: LFOs locked to the same song position, in one
+// instance or across several, produce the same values.
 #pragma once
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 class PeaksLFO {
 public:
     enum Waveform { SINE, TRIANGLE, SQUARE, STEPS, RANDOM };
-    void setSampleRate(float sr) { sampleRate = sr; }
-    void setFrequency(float f) { freq = f; phaseInc = freq / sampleRate; }
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; phaseInc = freq / sampleRate; } }
+    void setFrequency(float f) { if (f != freq) { freq = f; phaseInc = freq / sampleRate; } }
     void setWaveform(Waveform w) { waveform = w; }
-    void setVariation(float v) { variation = v; }
-    void reset() { phase = 0.0f; lastStep = 0.0f; }
+    void setVariation(float v) { if (v != variation) { variation = v; steps = 2 + int(variation * 14.0f); } }
+    // Jump to phase (0..1) of cycle `cycleIndex`, e.g. from the host's song position
+    void setPhase(float p, uint32_t cycleIndex) { phase = p; cycle = cycleIndex; }
+    void reset() { phase = 0.0; cycle = 0; }
     float process() {
-        phase += phaseInc;
-        if (phase >= 1.0f) phase -= 1.0f;
+        float out;
+        processBlock(&out, 1);
+        return out;
+    }
+    void processBlock(float* out, uint32_t n) {
+        // Below 1 even where the double rounds up
+        const float start = std::min(float(phase), 0x1.fffffep-1f), inc = phaseInc;
         switch (waveform) {
             case SINE:
-                return std::sin(2.0f * M_PI * phase);
+                for (uint32_t i = 0; i < n; ++i) out[i] = sin2Pi(wrap(start + inc * float(i + 1)));
+                break;
             case TRIANGLE:
-                return 2.0f * fabs(2.0f * phase - 1.0f) - 1.0f;
+                for (uint32_t i = 0; i < n; ++i) out[i] = 2.0f * std::fabs(2.0f * wrap(start + inc * float(i + 1)) - 1.0f) - 1.0f;
+                break;
             case SQUARE:
-                return (phase < 0.5f) ? 1.0f : -1.0f;
+                for (uint32_t i = 0; i < n; ++i) out[i] = wrap(start + inc * float(i + 1)) < 0.5f ? 1.0f : -1.0f;
+                break;
             case STEPS: {
-                int steps = 2 + int(variation * 14.0f); // 2-16 steps
-                float step = std::floor(phase * steps) / (steps - 1.0f) * 2.0f - 1.0f;
-                return step;
+                const float count = float(steps), scale = 2.0f / (float(steps) - 1.0f);
+                for (uint32_t i = 0; i < n; ++i) out[i] = float(int32_t(wrap(start + inc * float(i + 1)) * count)) * scale - 1.0f;
+                break;
             }
             case RANDOM:
-                if (phase < lastStep) curRand = 2.0f * ((float)rand() / RAND_MAX) - 1.0f;
-                lastStep = phase;
-                return curRand;
+                for (uint32_t i = 0; i < n; ++i) {
+                    const uint32_t c = cycle + uint32_t(int32_t(start + inc * float(i + 1)));
+                    out[i] = float(hash(kSeed + c) >> 8) * (2.0f / 16777216.0f) - 1.0f;
+                }
+                break;
         }
-        return 0.0f;
+        const double end = phase + double(inc) * double(n);
+        const double wraps = std::floor(end);
+        phase = end - wraps;
+        cycle += uint32_t(wraps);
     }
 private:
+    // Phases are never negative, so truncation is floor and vectorizes
+    static float wrap(float p) { return p - float(int32_t(p)); }
+    // sin(2 pi p) for p in [0, 1): fold to a quarter wave, then an odd
+    // polynomial (error < 4e-6)
+    static float sin2Pi(float p) {
+        const float x = p - 0.5f; // sin(2 pi p) = -sin(2 pi x)
+        const float a = std::fabs(x);
+        const float t = 6.28318531f * std::copysign(a > 0.25f ? 0.5f - a : a, x);
+        const float t2 = t * t;
+        return -t * (1.0f - t2 * (1.0f / 6.0f) * (1.0f - t2 * (1.0f / 20.0f) * (1.0f - t2 * (1.0f / 42.0f) * (1.0f - t2 * (1.0f / 72.0f)))));
+    }
+    static constexpr uint32_t kSeed = 0x5eed1f0u;
+    static uint32_t hash(uint32_t x) {
+        x ^= x >> 16; x *= 0x7feb352dU;
+        x ^= x >> 15; x *= 0x846ca68bU;
+        x ^= x >> 16;
+        return x;
+    }
     float sampleRate = 48000.0f;
     float freq = 1.0f;
-    float phase = 0.0f;
-    float phaseInc = 0.0f;
+    double phase = 0.0;
+    float phaseInc = freq / sampleRate;
     Waveform waveform = SINE;
     float variation = 0.0f;
-    float lastStep = 0.0f;
-    float curRand = 0.0f;
+    int steps = 2; // 2-16 steps, derived from variation
+    uint32_t cycle = 0;
 };
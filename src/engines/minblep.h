@@ -0,0 +1,228 @@
+// minblep.h - Shared minBLEP/minBLAMP oscillator core
+// A minimum-phase band-limited step and ramp are tabulated once per process,
+// on the first activation.
+// Oscillators write their naive waveform into a block and report every
+// discontinuity (value step or slope change) with its sub-sample position;
+// BlepBuffer accumulates the band-limited residuals and adds them to the
+// whole block in a single vectorizable pass.
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+#include "fft.h"
+
+class MinBlepTable {
+public:
+    static constexpr int kZeroCrossings = 16;
+    static constexpr int kOversample = 64;
+    static constexpr int kTaps = 2 * kZeroCrossings;
+    // Fraction of the output Nyquist frequency; the transition band then
+    // ends close to Nyquist instead of folding back over it
+    static constexpr double kCutoff = 0.9;
+
+    MinBlepTable() { build(); }
+
+    // Residuals of a unit step (or unit slope change) that happened
+    // row / kOversample samples before tap 0. Row kOversample is row 0 shifted
+    // by one sample, so adjacent rows can always be interpolated.
+    const float* stepRow(int row) const { return step + row * kTaps; }
+    const float* rampRow(int row) const { return ramp + row * kTaps; }
+
+private:
+    void build() {
+        const int length = kTaps * kOversample;
+        const int fftSize = 8 * length;
+        std::vector<std::complex<double>> x(fftSize);
+        // Blackman-windowed sinc
+        for (int i = 0; i < length; ++i) {
+            const double t = kCutoff * double(i - length / 2) / kOversample;
+            const double sinc = t == 0.0 ? 1.0 : std::sin(M_PI * t) / (M_PI * t);
+            const double w = 2.0 * M_PI * i / length;
+            x[i] = sinc * (0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w));
+        }
+        // Minimum phase via the folded real cepstrum
+        Fft<double> fft(fftSize);
+        fft.forward(x.data());
+        for (auto& v : x) v = std::log(std::max(std::abs(v), 1e-12));
+        fft.inverse(x.data());
+        for (int i = 1; i < fftSize; ++i) {
+            if (i < fftSize / 2) x[i] = 2.0 * x[i].real();
+            else if (i > fftSize / 2) x[i] = 0.0;
+        }
+        x[0] = x[0].real();
+        x[fftSize / 2] = x[fftSize / 2].real();
+        fft.forward(x.data());
+        for (auto& v : x) v = std::exp(v);
+        fft.inverse(x.data());
+
+        // Integrate to the band-limited step, settling exactly at 1
+        std::vector<double> blep(length + 1);
+        double sum = 0.0;
+        for (int i = 0; i < length; ++i) blep[i] = (sum += x[i].real());
+        for (int i = 0; i < length; ++i) blep[i] /= sum;
+        blep[length] = 1.0;
+
+        // Step residual blep - 1, and its integral for slope changes. The
+        // minimum-phase ramp lags the naive one by `lag` samples; a matching
+        // band-limited step is folded in so the ramp residual also decays to 0.
+        std::vector<double> integral(length + 1);
+        double acc = 0.0;
+        for (int i = 0; i <= length; ++i) {
+            integral[i] = acc;
+            acc += (blep[i] - 1.0) / kOversample;
+        }
+        const double lag = -integral[length];
+        for (int row = 0; row <= kOversample; ++row) {
+            for (int k = 0; k < kTaps; ++k) {
+                const int i = k * kOversample + row;
+                step[row * kTaps + k] = float(blep[i] - 1.0);
+                ramp[row * kTaps + k] = float(integral[i] + lag * blep[i]);
+            }
+        }
+    }
+
+    float step[(kOversample + 1) * kTaps];
+    float ramp[(kOversample + 1) * kTaps];
+};
+
+// Built on first use rather than at load, so host scans don't pay for the
+// FFTs. SynthEngines::Slot::prepare() makes that first use, in activate().
+inline const MinBlepTable& minBlepTable() {
+    static const MinBlepTable table;
+    return table;
+}
+
+// Pending band-limiting corrections for the current block and the tail that
+// spills into the next one
+class BlepBuffer {
+public:
+    static constexpr int kMaxBlock = 64;
+    static constexpr int kTaps = MinBlepTable::kTaps;
+
+    // A step of `amplitude` happened `offset` (0..1) samples before sample
+    // `index` of the block; sample `index` already holds the new value.
+    void addStep(int index, float offset, float amplitude) {
+        accumulate(index, offset, amplitude, &MinBlepTable::stepRow);
+    }
+
+    // The slope changed by `slopeChange` per sample, `offset` samples before `index`
+    void addRamp(int index, float offset, float slopeChange) {
+        accumulate(index, offset, slopeChange, &MinBlepTable::rampRow);
+    }
+
+    // Add the corrections for samples [0, n) and carry the tail over
+    void apply(float* out, int n) {
+        for (int i = 0; i < n; ++i) out[i] += pending[i];
+        std::copy(pending + n, pending + n + kTaps, pending);
+        std::fill(pending + kTaps, pending + kTaps + n, 0.0f);
+    }
+
+    void reset() { std::fill(pending, pending + kMaxBlock + kTaps, 0.0f); }
+
+private:
+    void accumulate(int index, float offset, float amount, const float* (MinBlepTable::*rowOf)(int) const) {
+        float pos = offset * MinBlepTable::kOversample;
+        if (!(pos > 0.0f)) pos = 0.0f;
+        int row = int(pos);
+        if (row >= MinBlepTable::kOversample) row = MinBlepTable::kOversample - 1;
+        const float frac = std::min(pos - float(row), 1.0f);
+        const float* r0 = (minBlepTable().*rowOf)(row);
+        const float* r1 = r0 + kTaps;
+        float* dst = pending + index;
+        for (int k = 0; k < kTaps; ++k) dst[k] += amount * (r0[k] + frac * (r1[k] - r0[k]));
+    }
+
+    alignas(16) float pending[kMaxBlock + kTaps] = {};
+};
+
+// Saw/pulse/triangle mix with hard sync. process() returns the naive sample
+// and reports each edge and corner to the BlepBuffer.
+class BlepOscillator {
+public:
+    void setShape(float sawAmount, float pulseAmount, float triangleAmount) {
+        saw = sawAmount;
+        pulse = pulseAmount;
+        tri = triangleAmount;
+    }
+    // Fraction of the cycle the pulse is high, in (0, 1)
+    void setPulseWidth(float width) { pulseWidth = width; }
+    void reset(float startPhase = 0.0f) {
+        phase = startPhase;
+        pulseHigh = startPhase < pulseWidth;
+        wrapOffset = -1.0f;
+    }
+    float getPhase() const { return phase; }
+
+    // Offset of the cycle restart during the last call, or -1 if there was
+    // none; feed it to a slave's processSynced().
+    float lastWrap() const { return wrapOffset; }
+
+    float process(float inc, BlepBuffer& blep, int index) {
+        wrapOffset = -1.0f;
+        advance(inc, 1.0f, 0.0f, blep, index);
+        return value(phase);
+    }
+
+    // As process(), but the cycle is restarted `syncOffset` samples before
+    // `index` when syncOffset >= 0
+    float processSynced(float inc, float syncOffset, BlepBuffer& blep, int index) {
+        if (syncOffset < 0.0f) return process(inc, blep, index);
+        wrapOffset = -1.0f;
+        advance(inc, 1.0f - syncOffset, syncOffset, blep, index);
+        blep.addStep(index, syncOffset, value(0.0f) - value(phase));
+        if (tri != 0.0f) blep.addRamp(index, syncOffset, (slope(0.0f) - slope(phase)) * inc);
+        phase = 0.0f;
+        pulseHigh = true;
+        advance(inc, syncOffset, 0.0f, blep, index);
+        wrapOffset = syncOffset;
+        return value(phase);
+    }
+
+private:
+    float value(float p) const {
+        return saw * (2.0f * p - 1.0f) + pulse * (p < pulseWidth ? 1.0f : -1.0f)
+             + tri * (p < 0.5f ? 4.0f * p - 1.0f : 3.0f - 4.0f * p);
+    }
+    // Per cycle
+    float slope(float p) const { return 2.0f * saw + (p < 0.5f ? 4.0f : -4.0f) * tri; }
+
+    // Move the phase by inc * span, ending `endOffset` samples before `index`
+    void advance(float inc, float span, float endOffset, BlepBuffer& blep, int index) {
+        float p = phase + inc * span;
+        if (p >= 1.0f) {
+            p -= 1.0f;
+            const float at = endOffset + p / inc;
+            edges(phase, 1.0f, at, inc, blep, index);
+            // Saw falls by 2, pulse rises by 2, triangle turns upward
+            blep.addStep(index, at, 2.0f * (pulse - saw));
+            if (tri != 0.0f) blep.addRamp(index, at, 8.0f * tri * inc);
+            pulseHigh = true;
+            edges(0.0f, p, endOffset, inc, blep, index);
+            wrapOffset = at;
+        } else {
+            edges(phase, p, endOffset, inc, blep, index);
+        }
+        phase = p;
+    }
+
+    // Pulse edges and triangle peak inside (from, to]. The pulse edge is found
+    // from the high/low state so a width modulated per sample cannot skip it.
+    void edges(float from, float to, float endOffset, float inc, BlepBuffer& blep, int index) {
+        const bool high = to < pulseWidth;
+        if (high != pulseHigh) {
+            if (pulse != 0.0f)
+                blep.addStep(index, endOffset + std::max(to - pulseWidth, 0.0f) / inc, high ? 2.0f * pulse : -2.0f * pulse);
+            pulseHigh = high;
+        }
+        if (tri != 0.0f && from < 0.5f && 0.5f <= to)
+            blep.addRamp(index, endOffset + (to - 0.5f) / inc, -8.0f * tri * inc);
+    }
+
+    float saw = 1.0f, pulse = 0.0f, tri = 0.0f;
+    float pulseWidth = 0.5f;
+    float phase = 0.0f;
+    bool pulseHigh = true;
+    float wrapOffset = -1.0f;
+};
@@ -0,0 +1,147 @@
+// modal_engine.h
+// Modal resonator engine: a bank of two-pole resonators struck, plucked or
+// bowed by the String engine's exciter.
+//   harmonics: structure, from a harmonic string (0) through stiff strings to
+//              free bars and bells (1) with a second, detuned mode family
+//   timbre:    exciter (pluck, bow, strike in thirds) and brightness: how fast
+//              and how loud the upper modes ring relative to the fundamental
+//   morph:     decay, 50 ms to 8 s
+// The bank is kept as structure-of-arrays and run a SIMD group at a time (8
+// modes with AVX, 4 with SSE). Modes above 0.45 fs are silenced, and groups
+// with no live mode are skipped, so a dense bell costs little more than a
+// plain tone.
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "exciter.h"
+#include "oversampler.h"
+#include "simd.h"
+
+class ModalEngine {
+public:
+    static constexpr const char* kName = "Modal";
+    static constexpr bool kRandomStart = true; // excited by noise
+    static constexpr int maxModes = 64;
+
+    ModalEngine() { exciter.setFreeRunning(false); }
+
+    // Setters only flag the mode table; it is rebuilt at the next block
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; modesDirty = true; } }
+    void setFrequency(float freq) { if (freq != frequency) { frequency = freq; modesDirty = true; } }
+    void setHarmonics(float h) { if (h != harmonics) { harmonics = h; modesDirty = true; } }
+    void setTimbre(float t) { if (t != timbre) { timbre = t; modesDirty = true; } }
+    void setMorph(float m) { if (m != morph) { morph = m; modesDirty = true; } }
+    void setLevel(float l) { level = l; }
+    void setOversampling(int factor) { saturatorL.setFactor(factor); saturatorR.setFactor(factor); }
+    // New note: restart the pluck or strike
+    void trigger() { exciter.trigger(); }
+    void reset() {
+        std::fill(y1, y1 + maxModes, 0.0f);
+        std::fill(y2, y2 + maxModes, 0.0f);
+        exciter.reset();
+        saturatorL.reset(); saturatorR.reset();
+    }
+
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
+        if (modesDirty) updateModes();
+        const float model = timbre;
+        const float position = 0.5f * (1.0f - timbre); // brighter, shorter bursts
+        const float drive = StringExciter::isBow(model) ? bowGain : 1.0f;
+        for (uint32_t i = 0; i < n; ++i) {
+            const simd::Vec x = simd::set1(drive * exciter.process(model, position, sampleRate));
+            simd::Vec accL = simd::zero(), accR = simd::zero();
+            for (int m = 0; m < activeModes; m += simd::kWidth) {
+                const simd::Vec p1 = simd::load(y1 + m);
+                const simd::Vec p2 = simd::load(y2 + m);
+                const simd::Vec y = simd::sub(simd::add(simd::mul(simd::load(b + m), x),
+                                                           simd::mul(simd::load(a1 + m), p1)),
+                                                simd::mul(simd::load(a2 + m), p2));
+                simd::store(y2 + m, p1);
+                simd::store(y1 + m, y);
+                accL = simd::add(accL, simd::mul(y, simd::load(gainL + m)));
+                accR = simd::add(accR, simd::mul(y, simd::load(gainR + m)));
+            }
+            left[i] = simd::sum(accL);
+            right[i] = simd::sum(accR);
+        }
+        // Long decays end in denormals; flush them once per block
+        for (int m = 0; m < activeModes; ++m) {
+            if (std::fabs(y1[m]) < 1e-15f) y1[m] = 0.0f;
+            if (std::fabs(y2[m]) < 1e-15f) y2[m] = 0.0f;
+        }
+        saturatorL.process(left, n, [](float v) { return std::tanh(v); });
+        saturatorR.process(right, n, [](float v) { return std::tanh(v); });
+        for (uint32_t i = 0; i < n; ++i) {
+            left[i] *= level;
+            right[i] *= level;
+        }
+    }
+
+private:
+    void updateModes() {
+        modesDirty = false;
+        const float nyquistLimit = 0.45f * sampleRate;
+        const float stiffness = 0.25f * harmonics * harmonics * harmonics;
+        const float detune = 1.0f + 0.4142f * harmonics; // second family, up to a tritone above
+        const float decay = 0.05f * std::pow(160.0f, morph); // 50 ms .. 8 s
+        const float damping = 0.05f + 0.6f * (1.0f - timbre) * (1.0f - timbre);
+        const float tilt = 1.2f * (1.0f - timbre);
+        int last = -1;
+        for (int k = 0; k < maxModes; ++k) {
+            // Even slots: bending modes; odd slots: the detuned family, which
+            // fades in with harmonics
+            const float partial = float(k / 2 + 1);
+            float ratio = partial * std::sqrt(1.0f + stiffness * (partial * partial - 1.0f));
+            float amp = std::pow(ratio, -tilt);
+            if (k & 1) {
+                ratio *= detune;
+                amp *= harmonics;
+            }
+            const float freq = frequency * ratio;
+            if (freq >= nyquistLimit || amp <= 0.0f) {
+                a1[k] = a2[k] = b[k] = gainL[k] = gainR[k] = 0.0f;
+                y1[k] = y2[k] = 0.0f;
+                continue;
+            }
+            last = k;
+            const float w = 2.0f * float(M_PI) * freq / sampleRate;
+            const float t60 = decay / (1.0f + damping * (ratio - 1.0f));
+            const float r = std::exp(-6.9078f / (t60 * sampleRate));
+            a1[k] = 2.0f * r * std::cos(w);
+            a2[k] = r * r;
+            b[k] = std::sin(w) * kInputGain; // unit-amplitude impulse response
+            // Spread the modes across the stereo field
+            const float angle = 0.785398f + 0.5f * std::sin(1.7f * float(k));
+            gainL[k] = amp * std::cos(angle);
+            gainR[k] = amp * std::sin(angle);
+        }
+        activeModes = (last + simd::kWidth) / simd::kWidth * simd::kWidth;
+        // Bowed, a mode settles where it loses as much as it gains; scale the
+        // bow by the fundamental's loss (1 - r^2) so sustain doesn't grow with decay
+        bowGain = kBowGain * std::sqrt(1.0f - a2[0]);
+    }
+
+    static constexpr float kInputGain = 0.5f;
+    static constexpr float kBowGain = 10.0f;
+
+    alignas(32) float a1[maxModes] = {};
+    alignas(32) float a2[maxModes] = {};
+    alignas(32) float b[maxModes] = {};
+    alignas(32) float gainL[maxModes] = {};
+    alignas(32) float gainR[maxModes] = {};
+    alignas(32) float y1[maxModes] = {};
+    alignas(32) float y2[maxModes] = {};
+    int activeModes = 0; // a multiple of the SIMD width
+    float bowGain = 1.0f;
+    bool modesDirty = true;
+    float sampleRate = 48000.0f;
+    float frequency = 440.0f;
+    float harmonics = 0.5f;
+    float timbre = 0.5f;
+    float morph = 0.5f;
+    float level = 1.0f;
+    StringExciter exciter;
+    Oversampler saturatorL, saturatorR;
+};
@@ -0,0 +1,155 @@
+// oversampler.h - Polyphase IIR half-band oversampling around nonlinear stages
+// Each 2x stage is a pair of first-order allpass chains running at the lower
+// rate (power-complementary half-band, no multiplies wasted on zero taps).
+// Stages cascade to 2x/4x/8x; only the function passed to process() runs at
+// the high rate, everything else in the engine stays at the base rate.
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+// Designed with the elliptic polyphase half-band formula. Stage 0 passes
+// 0..0.42 fs and rejects images by 99 dB; later stages only have to reject
+// images of an already band-limited signal, so they are much shorter.
+struct HalfBandCoefs {
+    static constexpr float kStage0[8] = { 0.040633461f, 0.150505129f, 0.300757056f, 0.460774505f,
+                                          0.609524315f, 0.738503841f, 0.849223810f, 0.949742784f }; // -99 dB
+    static constexpr float kStage1[4] = { 0.063676136f, 0.236978866f, 0.486229081f, 0.802361914f }; // -82 dB
+    static constexpr float kStage2[3] = { 0.084301153f, 0.323250006f, 0.715771190f };               // -74 dB
+};
+
+template <int N>
+class HalfBand {
+public:
+    explicit HalfBand(const float (&c)[N]) : coefs(c) {}
+
+    void reset() {
+        std::fill(x, x + N, 0.0f);
+        std::fill(y, y + N, 0.0f);
+    }
+
+    // One sample in, two out
+    void upsample(float in, float* out) {
+        float a = in, b = in;
+        run(a, b);
+        out[0] = a;
+        out[1] = b;
+    }
+
+    // Two samples in, one out
+    float downsample(const float* in) {
+        float a = in[1], b = in[0];
+        run(a, b);
+        return 0.5f * (a + b);
+    }
+
+private:
+    // Even coefficients filter path a, odd ones path b
+    void run(float& a, float& b) {
+        for (int i = 0; i < N; i += 2) {
+            const float ta = (a - y[i]) * coefs[i] + x[i];
+            x[i] = a;
+            y[i] = ta;
+            a = ta;
+            if (i + 1 < N) {
+                const float tb = (b - y[i + 1]) * coefs[i + 1] + x[i + 1];
+                x[i + 1] = b;
+                y[i + 1] = tb;
+                b = tb;
+            }
+        }
+    }
+
+    const float* coefs;
+    float x[N] = {};
+    float y[N] = {};
+};
+
+class Oversampler {
+public:
+    static constexpr int kMaxStages = 3;
+    static constexpr int kMaxFactor = 1 << kMaxStages;
+    static constexpr int kMaxBlock = 64;
+
+    // 1, 2, 4 or 8 (other values round down). Clears the filter state when
+    // the factor changes.
+    void setFactor(int factor) {
+        int s = 0;
+        while (s < kMaxStages && (2 << s) <= factor) ++s;
+        if (s != stages) {
+            stages = s;
+            reset();
+        }
+    }
+    int getFactor() const { return 1 << stages; }
+
+    void reset() {
+        up0.reset(); up1.reset(); up2.reset();
+        down0.reset(); down1.reset(); down2.reset();
+    }
+
+    // Replace every sample of block with its value through fn evaluated at
+    // the oversampled rate. fn must be a memoryless (or rate-aware) function
+    // of one sample.
+    template <typename Fn>
+    void process(float* block, uint32_t n, Fn&& fn) {
+        if (stages == 0) {
+            for (uint32_t i = 0; i < n; ++i) block[i] = fn(block[i]);
+            return;
+        }
+        alignas(16) float bufA[kMaxBlock * kMaxFactor];
+        alignas(16) float bufB[kMaxBlock * kMaxFactor];
+        while (n > 0) {
+            const int count = int(std::min<uint32_t>(n, kMaxBlock));
+            upsample(up0, block, bufA, count);
+            float* hi = bufA;
+            int len = count * 2;
+            if (stages > 1) { upsample(up1, bufA, bufB, len); hi = bufB; len *= 2; }
+            if (stages > 2) { upsample(up2, bufB, bufA, len); hi = bufA; len *= 2; }
+            for (int i = 0; i < len; ++i) hi[i] = fn(hi[i]);
+            if (stages > 2) { len /= 2; downsample(down2, hi, hi, len); }
+            if (stages > 1) { len /= 2; downsample(down1, hi, hi, len); }
+            downsample(down0, hi, block, count);
+            block += count;
+            n -= uint32_t(count);
+        }
+    }
+
+    // Fill block with n samples of a signal made at the oversampled rate:
+    // fn(hi, len) writes len <= kMaxBlock * factor consecutive samples. For
+    // sources with content near the base Nyquist, whose images the
+    // upsampler's transition band would let through.
+    template <typename Fn>
+    void render(float* block, uint32_t n, Fn&& fn) {
+        if (stages == 0) {
+            fn(block, n);
+            return;
+        }
+        alignas(16) float buf[kMaxBlock * kMaxFactor];
+        while (n > 0) {
+            const int count = int(std::min<uint32_t>(n, kMaxBlock));
+            int len = count << stages;
+            fn(buf, uint32_t(len));
+            if (stages > 2) { len /= 2; downsample(down2, buf, buf, len); }
+            if (stages > 1) { len /= 2; downsample(down1, buf, buf, len); }
+            downsample(down0, buf, block, count);
+            block += count;
+            n -= uint32_t(count);
+        }
+    }
+
+private:
+    template <int N>
+    static void upsample(HalfBand<N>& stage, const float* in, float* out, int n) {
+        for (int i = 0; i < n; ++i) stage.upsample(in[i], out + 2 * i);
+    }
+    // n output samples; out may alias in
+    template <int N>
+    static void downsample(HalfBand<N>& stage, const float* in, float* out, int n) {
+        for (int i = 0; i < n; ++i) out[i] = stage.downsample(in + 2 * i);
+    }
+
+    HalfBand<8> up0{HalfBandCoefs::kStage0}, down0{HalfBandCoefs::kStage0};
+    HalfBand<4> up1{HalfBandCoefs::kStage1}, down1{HalfBandCoefs::kStage1};
+    HalfBand<3> up2{HalfBandCoefs::kStage2}, down2{HalfBandCoefs::kStage2};
+    int stages = 0;
+};
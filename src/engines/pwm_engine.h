@@ -1,91 +1,99 @@
 #pragma once
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include "minblep.h"
+#include "oversampler.h"
+#include "rate_scale.h"
 
 
 // Greatly improved PWM engine: bandlimited, analog drift, stereo spread, DC blocking, rich harmonics
 class PWMEngine {
 public:
-    PWMEngine() : sampleRate(48000.0f), phaseL(0.0f), phaseR(0.0f), driftPhase(0.0f), dcL(0.0f), dcR(0.0f) {}
-    void setSampleRate(float sr) { sampleRate = sr; }
+    static constexpr const char* kName = "PWM";
+    PWMEngine() { oscL.setShape(0.0f, -1.0f, 0.0f); oscR.setShape(0.0f, -1.0f, 0.0f); }
+    void setSampleRate(float sr) {
+        if (sr == sampleRate) return;
+        sampleRate = sr;
+        phaseInc = freq / sampleRate;
+        dcCoef = rateCoef(0.995f, sr);
+        driftScale = rateStep(1.0f, sr);
+    }
     void setFrequency(float f) { freq = f; phaseInc = f / sampleRate; }
     void setHarmonics(float h) { harmonics = h; } // 0–1, controls saturation and noise
     void setTimbre(float t) { basePW = 0.05f + 0.9f * t; } // 0.05–0.95
     void setMorph(float m) { morph = m; } // 0–1, controls PWM LFO depth/rate
     void setLevel(float l) { level = l; }
-    void reset() { phaseL = phaseR = driftPhase = 0.0f; dcL = dcR = 0.0f; }
-    void process(float& left, float& right) {
-        // Analog drift: slow random LFO modulates pulse width and phase
-        driftPhase += 0.0003f + 0.001f * morph; // morph = drift speed
-        if (driftPhase > 1.0f) driftPhase -= 1.0f;
-        float drift = 0.002f * std::sin(2.0f * 3.14159f * driftPhase + 6.28f * morph) + 0.001f * (rand()/(float)RAND_MAX - 0.5f);
-        // PWM LFO: morph controls depth and rate
-        float lfoRate = 0.2f + 5.0f * morph;
-        float lfoL = std::sin(2.0f * 3.14159f * lfoRate * phaseL);
-        float lfoR = std::sin(2.0f * 3.14159f * (lfoRate * 1.03f) * phaseR + 0.3f); // stereo spread
-        float pwL = basePW + 0.35f * morph * lfoL + drift;
-        float pwR = basePW + 0.35f * morph * lfoR - drift;
-        if (pwL < 0.05f) {
-            pwL = 0.05f;
-        }
-        if (pwL > 0.95f) {
-            pwL = 0.95f;
-        }
-        if (pwR < 0.05f) {
-            pwR = 0.05f;
-        }
-        if (pwR > 0.95f) {
-            pwR = 0.95f;
+    void reset() {
+        oscL.reset(); oscR.reset(); blepL.reset(); blepR.reset();
+        saturatorL.reset(); saturatorR.reset();
+        driftPhase = 0.0f; dcL = dcR = 0.0f;
+    }
+    void setOversampling(int factor) { saturatorL.setFactor(factor); saturatorR.setFactor(factor); }
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
+        while (n > 0) {
+            const int count = int(std::min<uint32_t>(n, BlepBuffer::kMaxBlock));
+            renderPulses(left, right, count);
+            // Noise for harmonics, then cubic + soft saturation at the oversampled rate
+            for (int i = 0; i < count; ++i) {
+                left[i] += (rand()/(float)RAND_MAX - 0.5f) * 0.01f * harmonics;
+                right[i] += (rand()/(float)RAND_MAX - 0.5f) * 0.01f * harmonics;
+            }
+            const float h = harmonics;
+            auto shaper = [h](float x) { return std::tanh(x + h * x * x * x); };
+            saturatorL.process(left, uint32_t(count), shaper);
+            saturatorR.process(right, uint32_t(count), shaper);
+            for (int i = 0; i < count; ++i) {
+                // DC blocking (simple 1-pole highpass)
+                float outL = dcBlock(left[i], dcL);
+                float outR = dcBlock(right[i], dcR);
+                // Level
+                left[i] = outL * level;
+                right[i] = outR * level;
+            }
+            left += count;
+            right += count;
+            n -= uint32_t(count);
         }
-        // Bandlimited PWM: two PolyBLEP saws
-        float sawL1 = polyblepSaw(phaseL);
-        float sawL2 = polyblepSaw(fmodf(phaseL + pwL, 1.0f));
-        float outL = sawL1 - sawL2;
-        float sawR1 = polyblepSaw(phaseR);
-        float sawR2 = polyblepSaw(fmodf(phaseR + pwR, 1.0f));
-        float outR = sawR1 - sawR2;
-        // Soft saturation and noise for harmonics
-        float noiseL = (rand()/(float)RAND_MAX - 0.5f) * 0.01f * harmonics;
-        float noiseR = (rand()/(float)RAND_MAX - 0.5f) * 0.01f * harmonics;
-        outL = std::tanh(outL + harmonics * outL * outL * outL + noiseL);
-        outR = std::tanh(outR + harmonics * outR * outR * outR + noiseR);
-        // DC blocking (simple 1-pole highpass)
-        outL = dcBlock(outL, dcL);
-        outR = dcBlock(outR, dcR);
-        // Level
-        left = outL * level;
-        right = outR * level;
-        // Advance phase
-        phaseL += phaseInc + drift * 0.1f;
-        phaseR += phaseInc - drift * 0.1f;
-        if (phaseL >= 1.0f) phaseL -= 1.0f;
-        if (phaseR >= 1.0f) phaseR -= 1.0f;
     }
 private:
     float sampleRate = 48000.0f, freq = 440.0f, phaseInc = 0.01f;
-    float phaseL = 0.0f, phaseR = 0.0f, driftPhase = 0.0f;
+    float driftPhase = 0.0f;
+    float driftScale = 1.0f, dcCoef = 0.995f;
     float basePW = 0.5f, harmonics = 0.0f, morph = 0.0f, level = 1.0f;
     float dcL = 0.0f, dcR = 0.0f;
-    // PolyBLEP bandlimited sawtooth
-    float polyblepSaw(float t) {
-        float dt = phaseInc;
-        float s = 2.0f * t - 1.0f;
-        s -= polyblep(t, dt);
-        if (t + dt > 1.0f) s -= polyblep((t + dt - 1.0f), dt);
-        return s;
-    }
-    // PolyBLEP step
-    float polyblep(float t, float dt) {
-        if (t < dt) {
-            t /= dt;
-            return t + t - t * t - 1.0f;
-        } else if (t > 1.0f - dt) {
-            t = (t - 1.0f) / dt;
-            return t * t + t + t + 1.0f;
-        } else return 0.0f;
+    BlepOscillator oscL, oscR;
+    BlepBuffer blepL, blepR;
+    Oversampler saturatorL, saturatorR;
+    // Band-limited PWM into left/right, count <= BlepBuffer::kMaxBlock. The
+    // difference of two saws pw apart is a pulse high for the last pw of the
+    // cycle: (1 - 2pw) minus a pulse of width 1 - pw.
+    void renderPulses(float* left, float* right, int count) {
+        for (int i = 0; i < count; ++i) {
+            // Analog drift: slow random LFO modulates pulse width and phase
+            driftPhase += (0.0003f + 0.001f * morph) * driftScale; // morph = drift speed
+            if (driftPhase > 1.0f) driftPhase -= 1.0f;
+            float drift = 0.002f * std::sin(2.0f * 3.14159f * driftPhase + 6.28f * morph) + 0.001f * (rand()/(float)RAND_MAX - 0.5f);
+            // PWM LFO: morph controls depth and rate
+            float lfoRate = 0.2f + 5.0f * morph;
+            float lfoL = std::sin(2.0f * 3.14159f * lfoRate * oscL.getPhase());
+            float lfoR = std::sin(2.0f * 3.14159f * (lfoRate * 1.03f) * oscR.getPhase() + 0.3f); // stereo spread
+            float pwL = std::clamp(basePW + 0.35f * morph * lfoL + drift, 0.05f, 0.95f);
+            float pwR = std::clamp(basePW + 0.35f * morph * lfoR - drift, 0.05f, 0.95f);
+            oscL.setPulseWidth(1.0f - pwL);
+            oscR.setPulseWidth(1.0f - pwR);
+            // Drift detunes by the same Hz at any rate
+            const float detune = drift * 0.1f * driftScale;
+            left[i] = 1.0f - 2.0f * pwL + oscL.process(std::max(phaseInc + detune, 0.0f), blepL, i);
+            right[i] = 1.0f - 2.0f * pwR + oscR.process(std::max(phaseInc - detune, 0.0f), blepR, i);
+        }
+        blepL.apply(left, count);
+        blepR.apply(right, count);
     }
     // DC blocker (1-pole highpass)
     float dcBlock(float in, float& state) {
-        float out = in - state + 0.995f * state;
+        float out = in - state + dcCoef * state;
         state = out;
         return out;
     }
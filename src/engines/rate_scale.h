@@ -0,0 +1,24 @@
+// rate_scale.h - Per-sample constants tuned at 48 kHz, carried to any rate
+// Several engines were voiced with literal per-sample coefficients (DC
+// blockers, decays, drift steps). These keep their time constants in seconds
+// at other host rates; at 48 kHz both return their argument unchanged, bit
+// for bit.
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+static constexpr float kReferenceRate = 48000.0f;
+
+// One-pole coefficient (decay per sample) tuned at 48 kHz, for rate sr
+inline float rateCoef(float coef, float sr) { return std::pow(coef, kReferenceRate / sr); }
+
+// Phase or ramp increment per sample tuned at 48 kHz, for rate sr
+inline float rateStep(float step, float sr) { return step * (kReferenceRate / sr); }
+
+// Frames of a masked (power-of-two) ring holding at least `seconds` at rate sr
+constexpr uint32_t ringFrames(float seconds, float sr) {
+    const uint32_t frames = uint32_t(seconds * sr);
+    uint32_t size = 1;
+    while (size < frames) size <<= 1;
+    return size;
+}
@@ -1,43 +1,38 @@
 // saw_engine.h
 #pragma once
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include "minblep.h"
+#include "oversampler.h"
+#include "rate_scale.h"
 
-// Improved SawEngine: PolyBLEP, morph, DC blocking
+// Improved SawEngine: minBLEP saw/square, morph, DC blocking
 class SawEngine {
 public:
-    void setSampleRate(float sr) { sampleRate = sr; }
+    static constexpr const char* kName = "Saw";
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; dcCoef = rateCoef(0.995f, sr); } }
     void setFrequency(float freq) { frequency = freq; }
     void setHarmonics(float h) { harmonics = h; }
     void setTimbre(float t) { timbre = t; }
     void setMorph(float m) { morph = m; }
-    void reset() { phase = 0.0f; lastOut = 0.0f; dc = 0.0f; }
+    void reset() { osc.reset(); blep.reset(); saturator.reset(); lastOut = 0.0f; dc = 0.0f; }
+    void setOversampling(int factor) { saturator.setFactor(factor); }
         void gate(bool g) { gateOn = g; }
         bool gateOn = false;
     // Stereo process for compatibility
-    void process(float& left, float& right) {
-        float v = process();
-        left = right = v * level;
-    }
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
     float process() {
-        float phaseInc = frequency / sampleRate;
-        phase += phaseInc;
-        if (phase >= 1.0f) phase -= 1.0f;
-        float saw = 2.0f * (phase - 0.5f);
-        saw -= polyblep(phase, phaseInc);
-        // Morph: blend saw and square
-        float sq = (phase < 0.5f ? 1.0f : -1.0f);
-        sq -= polyblep(phase, phaseInc);
-        float out = (1.0f - morph) * saw + morph * sq;
-        // Harmonics: add a little 2nd/3rd for color
-        out += harmonics * 0.18f * std::sin(4.0f * M_PI * phase);
-        out += harmonics * 0.09f * std::sin(6.0f * M_PI * phase);
-        // Timbre: soft saturation
-        out = std::tanh(out * (1.0f + timbre * 2.0f));
-        // DC blocker
-        float dcBlock = out - lastOut + 0.995f * dc;
-        lastOut = out;
-        dc = dcBlock;
-        return dcBlock * 0.9f;
+        float v;
+        render(&v, 1);
+        return v;
+    }
+    void processBlock(float* left, float* right, uint32_t n) {
+        render(left, n);
+        for (uint32_t i = 0; i < n; ++i) {
+            left[i] *= level;
+            right[i] = left[i];
+        }
     }
     // Level (amplitude)
     void setLevel(float l) { level = l; }
@@ -58,24 +53,48 @@ public:
     float getMorph() const { return morph; }
     void getADSR(float& a, float& d, float& s, float& r) const { a = d = s = r = 0.0f; }
 private:
-    float polyblep(float t, float dt) {
-        if (t < dt) {
-            t /= dt;
-            return t + t - t * t - 1.0f;
-        } else if (t > 1.0f - dt) {
-            t = (t - 1.0f) / dt;
-            return t * t + t + t + 1.0f;
-        } else {
-            return 0.0f;
+    void render(float* out, uint32_t n) {
+        const float phaseInc = frequency / sampleRate;
+        // Morph: blend saw and square
+        osc.setShape(1.0f - morph, morph, 0.0f);
+        float phases[BlepBuffer::kMaxBlock];
+        while (n > 0) {
+            const int count = int(std::min<uint32_t>(n, BlepBuffer::kMaxBlock));
+            for (int i = 0; i < count; ++i) {
+                out[i] = osc.process(phaseInc, blep, i);
+                phases[i] = osc.getPhase();
+            }
+            blep.apply(out, count);
+            for (int i = 0; i < count; ++i) {
+                float v = out[i];
+                // Harmonics: add a little 2nd/3rd for color
+                v += harmonics * 0.18f * std::sin(4.0f * M_PI * phases[i]);
+                v += harmonics * 0.09f * std::sin(6.0f * M_PI * phases[i]);
+                // Timbre: drive into the (oversampled) soft saturation
+                out[i] = v * (1.0f + timbre * 2.0f);
+            }
+            saturator.process(out, uint32_t(count), [](float x) { return std::tanh(x); });
+            for (int i = 0; i < count; ++i) {
+                // DC blocker
+                float dcBlock = out[i] - lastOut + dcCoef * dc;
+                lastOut = out[i];
+                dc = dcBlock;
+                out[i] = dcBlock * 0.9f;
+            }
+            out += count;
+            n -= uint32_t(count);
         }
     }
+    BlepOscillator osc;
+    BlepBuffer blep;
+    Oversampler saturator;
     float sampleRate = 48000.0f;
     float frequency = 440.0f;
     float harmonics = 0.0f;
     float timbre = 0.5f;
     float morph = 0.0f;
-    float phase = 0.0f;
     float lastOut = 0.0f;
     float dc = 0.0f;
+    float dcCoef = 0.995f;
     float level = 1.0f;
 };
@@ -0,0 +1,57 @@
+// simd.h - Minimal float vector wrapper for the banked engines
+// Picks the widest unit the build targets: 8 lanes with AVX, 4 with SSE2,
+// plain floats otherwise. Engines lay their per-mode or per-string state out
+// as structure-of-arrays padded to kWidth and step through it a vector at a
+// time; loads and stores expect kAlign-aligned addresses.
+#pragma once
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace simd {
+#if defined(__AVX__)
+using Vec = __m256;
+constexpr int kWidth = 8;
+inline Vec load(const float* p) { return _mm256_load_ps(p); }
+inline void store(float* p, Vec v) { _mm256_store_ps(p, v); }
+inline Vec set1(float x) { return _mm256_set1_ps(x); }
+inline Vec zero() { return _mm256_setzero_ps(); }
+inline Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+inline Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+inline Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+inline float sum(Vec v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+#elif defined(__SSE2__)
+using Vec = __m128;
+constexpr int kWidth = 4;
+inline Vec load(const float* p) { return _mm_load_ps(p); }
+inline void store(float* p, Vec v) { _mm_store_ps(p, v); }
+inline Vec set1(float x) { return _mm_set1_ps(x); }
+inline Vec zero() { return _mm_setzero_ps(); }
+inline Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+inline Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+inline Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+inline float sum(Vec v) {
+    const __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+#else
+using Vec = float;
+constexpr int kWidth = 1;
+inline Vec load(const float* p) { return *p; }
+inline void store(float* p, Vec v) { *p = v; }
+inline Vec set1(float x) { return x; }
+inline Vec zero() { return 0.0f; }
+inline Vec add(Vec a, Vec b) { return a + b; }
+inline Vec sub(Vec a, Vec b) { return a - b; }
+inline Vec mul(Vec a, Vec b) { return a * b; }
+inline float sum(Vec v) { return v; }
+#endif
+constexpr int kAlign = kWidth * 4 < 16 ? 16 : kWidth * 4;
+
+// a + b * c
+inline Vec madd(Vec a, Vec b, Vec c) { return add(a, mul(b, c)); }
+} // namespace simd
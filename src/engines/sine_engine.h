@@ -1,41 +1,36 @@
 // sine_engine.h
 #pragma once
 #include <cmath>
+#include <cstdint>
+#include "oversampler.h"
+#include "rate_scale.h"
 
 // Improved SineEngine: better morph/timbre, DC blocking
 class SineEngine {
 public:
-    void setSampleRate(float sr) { sampleRate = sr; }
+    static constexpr const char* kName = "Sine";
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; dcCoef = rateCoef(0.995f, sr); } }
     void setFrequency(float freq) { frequency = freq; }
     void setHarmonics(float h) { harmonics = h; }
     void setTimbre(float t) { timbre = t; }
     void setMorph(float m) { morph = m; }
-    void reset() { phase = 0.0f; lastOut = 0.0f; dc = 0.0f; }
+    void reset() { phase = 0.0f; saturator.reset(); lastOut = 0.0f; dc = 0.0f; }
+    void setOversampling(int factor) { saturator.setFactor(factor); }
     void gate(bool g) { gateOn = g; }
     // Stereo process for compatibility
-    void process(float& left, float& right) {
-    float v = process();
-    left = right = v * level;
-    }
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
     // Mono process
     float process() {
-        // Always output sound, ignore gate
-        float phaseInc = frequency / sampleRate;
-        phase += phaseInc;
-        if (phase >= 1.0f) phase -= 1.0f;
-        // Morph: blend sine and soft triangle
-        float tri = 2.0f * fabs(2.0f * phase - 1.0f) - 1.0f;
-        float out = (1.0f - morph) * std::sin(2.0f * M_PI * phase) + morph * tri;
-        // Harmonics: add a little 2nd/3rd harmonic for color
-        out += harmonics * 0.2f * std::sin(4.0f * M_PI * phase);
-        out += harmonics * 0.1f * std::sin(6.0f * M_PI * phase);
-        // Timbre: soft saturation
-        out = std::tanh(out * (1.0f + timbre * 2.0f));
-        // Simple DC blocker
-        float dcBlock = out - lastOut + 0.995f * dc;
-        lastOut = out;
-        dc = dcBlock;
-        return dcBlock * 0.9f;
+        float v;
+        render(&v, 1);
+        return v;
+    }
+    void processBlock(float* left, float* right, uint32_t n) {
+        render(left, n);
+        for (uint32_t i = 0; i < n; ++i) {
+            left[i] *= level;
+            right[i] = left[i];
+        }
     }
     // Level (amplitude)
     void setLevel(float l) { level = l; }
@@ -54,7 +49,31 @@ public:
     void getADSR(float& a, float& d, float& s, float& r) const { a = d = s = r = 0.0f; }
 private:
     bool gateOn = false;
-private:
+    void render(float* out, uint32_t n) {
+        // Always output sound, ignore gate
+        float phaseInc = frequency / sampleRate;
+        for (uint32_t i = 0; i < n; ++i) {
+            phase += phaseInc;
+            if (phase >= 1.0f) phase -= 1.0f;
+            // Morph: blend sine and soft triangle
+            float tri = 2.0f * fabs(2.0f * phase - 1.0f) - 1.0f;
+            float v = (1.0f - morph) * std::sin(2.0f * M_PI * phase) + morph * tri;
+            // Harmonics: add a little 2nd/3rd harmonic for color
+            v += harmonics * 0.2f * std::sin(4.0f * M_PI * phase);
+            v += harmonics * 0.1f * std::sin(6.0f * M_PI * phase);
+            // Timbre: drive into the (oversampled) soft saturation
+            out[i] = v * (1.0f + timbre * 2.0f);
+        }
+        saturator.process(out, n, [](float x) { return std::tanh(x); });
+        for (uint32_t i = 0; i < n; ++i) {
+            // Simple DC blocker
+            float dcBlock = out[i] - lastOut + dcCoef * dc;
+            lastOut = out[i];
+            dc = dcBlock;
+            out[i] = dcBlock * 0.9f;
+        }
+    }
+    Oversampler saturator;
     float sampleRate = 48000.0f;
     float frequency = 440.0f;
     float harmonics = 0.0f;
@@ -63,5 +82,6 @@ private:
     float phase = 0.0f;
     float lastOut = 0.0f;
     float dc = 0.0f;
+    float dcCoef = 0.995f;
     float level = 1.0f;
 };
@@ -0,0 +1,239 @@
+// string_bank_engine.h
+// Eight coupled Karplus-Strong strings, strummed together:
+//   harmonics: tuning of the bank, from the harmonic series through stacked
+//              fifths and open guitar strings to major, sus and minor 7th chords
+//   timbre:    brightness: loss filter, stiffness (dispersion) and pluck length
+//   morph:     decay, 0.3 s to 12 s, and how strongly the strings feed each
+//              other through the shared bridge (sympathetic resonance)
+// Each string is one SIMD lane. The delay lines share a single lane-
+// interleaved ring, so the write of all eight strings is one vector store;
+// only the reads, at a different length per string, are gathered lane by lane.
+// Interpolation, loss filter, dispersion allpass, bridge coupling and output
+// panning then run on whole vectors (one with AVX, two with SSE).
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include "oversampler.h"
+#include "rate_scale.h"
+#include "simd.h"
+
+class StringBankEngine {
+public:
+    static constexpr const char* kName = "String Bank";
+    static constexpr int kStrings = 8;
+    static constexpr float kLowestHz = 23.5f; // longest string the ring holds
+    static constexpr int kBlock = 64;
+
+    StringBankEngine() { trigger(); }
+
+    // The lane-interleaved ring: 2048 frames at 48 kHz, 8192 at 192 kHz
+    static constexpr std::size_t bufferSize(float sampleRate) {
+        return std::size_t(ringFrames(1.0f / kLowestHz, sampleRate)) * kStrings;
+    }
+    // memory must be 32-byte aligned: each frame is written with vector stores
+    void setBuffer(float* memory, float sampleRate) {
+        ring = memory;
+        maxDelay = int(ringFrames(1.0f / kLowestHz, sampleRate));
+        mask = uint32_t(maxDelay) - 1;
+        tuningDirty = true;
+    }
+
+    // Setters only flag the tuning; it is recomputed at the next block
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; tuningDirty = true; } }
+    void setFrequency(float f) { if (f != frequency) { frequency = f; tuningDirty = true; } }
+    void setHarmonics(float h) { if (h != harmonics) { harmonics = h; tuningDirty = true; } }
+    void setTimbre(float t) { if (t != timbre) { timbre = t; tuningDirty = true; } }
+    void setMorph(float m) { if (m != morph) { morph = m; tuningDirty = true; } }
+    void setLevel(float l) { level = l; }
+    void setOversampling(int factor) { saturatorL.setFactor(factor); saturatorR.setFactor(factor); }
+    // New note: strum all strings again, lowest lane first
+    void trigger() {
+        for (int k = 0; k < kStrings; ++k) {
+            onset[k] = k * int(kStrumSeconds * sampleRate);
+            burst[k] = 1.0f;
+        }
+        exciting = true;
+    }
+    void reset() {
+        std::fill(ring, ring + maxDelay * kStrings, 0.0f);
+        std::fill(lp, lp + kStrings, 0.0f);
+        std::fill(apIn, apIn + kStrings, 0.0f);
+        std::fill(apOut, apOut + kStrings, 0.0f);
+        writePos = 0;
+        saturatorL.reset(); saturatorR.reset();
+        trigger();
+    }
+
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
+        if (tuningDirty) updateTuning();
+        while (n > 0) {
+            const int count = int(std::min<uint32_t>(n, kBlock));
+            renderStrings(left, right, count);
+            left += count;
+            right += count;
+            n -= uint32_t(count);
+        }
+    }
+
+private:
+    void renderStrings(float* left, float* right, int count) {
+        if (exciting) renderExcitation(count);
+        const simd::Vec coupling = simd::set1(bridge);
+        const simd::Vec invStrings = simd::set1(1.0f / kStrings);
+        alignas(32) float tapA[kStrings], tapB[kStrings], y[kStrings];
+        for (int i = 0; i < count; ++i) {
+            // Gather: each string reads its own length behind the write head
+            for (int k = 0; k < kStrings; ++k) {
+                const uint32_t at = (writePos - uint32_t(delayInt[k])) & mask;
+                tapA[k] = ring[at * kStrings + k];
+                tapB[k] = ring[((at - 1) & mask) * kStrings + k];
+            }
+            simd::Vec total = simd::zero();
+            for (int k = 0; k < kStrings; k += simd::kWidth) {
+                const simd::Vec a = simd::load(tapA + k);
+                const simd::Vec x = simd::madd(a, simd::load(delayFrac + k), simd::sub(simd::load(tapB + k), a));
+                // One-pole loss filter, then the dispersion allpass
+                const simd::Vec l = simd::madd(x, simd::load(lpCoef + k), simd::sub(simd::load(lp + k), x));
+                const simd::Vec d = simd::madd(simd::load(apIn + k), simd::load(apCoef + k),
+                                               simd::sub(l, simd::load(apOut + k)));
+                simd::store(lp + k, l);
+                simd::store(apIn + k, l);
+                simd::store(apOut + k, d);
+                const simd::Vec s = simd::mul(d, simd::load(loss + k));
+                simd::store(y + k, s);
+                total = simd::add(total, s);
+            }
+            // The bridge pulls every string towards the bank's mean; the mix is
+            // an average, so it moves energy between strings without adding any
+            const simd::Vec mean = simd::mul(simd::set1(simd::sum(total)), invStrings);
+            simd::Vec outL = simd::zero(), outR = simd::zero();
+            float* frame = ring + writePos * kStrings;
+            for (int k = 0; k < kStrings; k += simd::kWidth) {
+                const simd::Vec s = simd::load(y + k);
+                const simd::Vec fed = simd::madd(s, coupling, simd::sub(mean, s));
+                simd::store(frame + k, exciting ? simd::add(fed, simd::load(excitation + i * kStrings + k)) : fed);
+                outL = simd::madd(outL, s, simd::load(panL + k));
+                outR = simd::madd(outR, s, simd::load(panR + k));
+            }
+            left[i] = simd::sum(outL);
+            right[i] = simd::sum(outR);
+            writePos = (writePos + 1) & mask;
+        }
+        if (exciting) exciting = std::any_of(burst, burst + kStrings, [](float b) { return b > 0.0f; });
+        // Long decays end in denormals; flush the filter states once per block
+        for (int k = 0; k < kStrings; ++k) {
+            if (std::fabs(lp[k]) < 1e-15f) lp[k] = 0.0f;
+            if (std::fabs(apIn[k]) < 1e-15f) apIn[k] = 0.0f;
+            if (std::fabs(apOut[k]) < 1e-15f) apOut[k] = 0.0f;
+        }
+        saturatorL.process(left, uint32_t(count), [](float v) { return std::tanh(v); });
+        saturatorR.process(right, uint32_t(count), [](float v) { return std::tanh(v); });
+        for (int i = 0; i < count; ++i) {
+            left[i] *= level;
+            right[i] *= level;
+        }
+    }
+
+    // Noise bursts of the strum for this block, frame by frame
+    void renderExcitation(int count) {
+        for (int i = 0; i < count; ++i) {
+            const float noise = random() - 0.5f;
+            for (int k = 0; k < kStrings; ++k) {
+                float e = 0.0f;
+                if (onset[k] > 0) {
+                    --onset[k];
+                } else if (burst[k] > 0.0f) {
+                    e = kExciteGain * noise * burst[k];
+                    burst[k] = std::max(burst[k] - burstStep, 0.0f);
+                }
+                excitation[i * kStrings + k] = e;
+            }
+        }
+    }
+
+    void updateTuning() {
+        tuningDirty = false;
+        const int chord = std::clamp(int(harmonics * (kChords - 1) + 0.5f), 0, kChords - 1);
+        const float decay = 0.3f * std::pow(40.0f, morph);
+        const float dull = (1.0f - timbre) * (1.0f - timbre);
+        const float b = 0.05f + 0.6f * dull;
+        const float a = -0.35f * timbre;
+        for (int k = 0; k < kStrings; ++k) {
+            const float freq = std::min(frequency * std::exp2(kTunings[chord][k] / 12.0f), 0.45f * sampleRate);
+            const float period = sampleRate / freq;
+            // The line is shortened by the filters' phase delay at the string's
+            // own pitch, so the loop stays in tune however dull or stiff
+            const std::complex<float> z = std::polar(1.0f, -2.0f * float(M_PI) / period);
+            const std::complex<float> filters = (1.0f - b) / (1.0f - b * z) * (a + z) / (1.0f + a * z);
+            const float filterDelay = -std::arg(filters) * period / (2.0f * float(M_PI));
+            const float d = std::clamp(period - filterDelay, 1.0f, float(maxDelay - 2));
+            delayInt[k] = int(d);
+            delayFrac[k] = d - float(delayInt[k]);
+            // Per pass through the loop, so every string rings for `decay`
+            loss[k] = std::exp(-6.9078f * period / (decay * sampleRate));
+            lpCoef[k] = b;
+            apCoef[k] = a;
+            const float angle = 0.785398f + 0.6f * (float(k) / (kStrings - 1) - 0.5f) * (k & 1 ? -1.0f : 1.0f);
+            panL[k] = kOutputGain * std::cos(angle);
+            panR[k] = kOutputGain * std::sin(angle);
+        }
+        bridge = 0.005f + 0.045f * morph;
+        burstStep = 1.0f / std::max((0.001f + 0.007f * dull) * sampleRate, 1.0f);
+    }
+
+    // 0..1, xorshift32
+    float random() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return float(rng >> 8) * (1.0f / 16777216.0f);
+    }
+
+    static constexpr int kChords = 6;
+    // Semitones above the played note, one row per chord
+    static constexpr float kTunings[kChords][kStrings] = {
+        { 0.0f, 12.0f, 19.02f, 24.0f, 27.86f, 31.02f, 33.69f, 36.0f }, // harmonic series
+        { -12.0f, -5.0f, 0.0f, 7.0f, 12.0f, 19.0f, 24.0f, 31.0f },     // stacked fifths
+        { 0.0f, 5.0f, 10.0f, 15.0f, 19.0f, 24.0f, 12.0f, 7.0f },       // open guitar, two sympathetic
+        { -12.0f, 0.0f, 4.0f, 7.0f, 12.0f, 16.0f, 19.0f, 24.0f },      // major
+        { 0.0f, 5.0f, 7.0f, 12.0f, 14.0f, 17.0f, 19.0f, 24.0f },       // sus
+        { 0.0f, 3.0f, 7.0f, 10.0f, 12.0f, 15.0f, 19.0f, 22.0f },       // minor 7th
+    };
+    static constexpr float kStrumSeconds = 0.006f;
+    static constexpr float kExciteGain = 2.0f;
+    static constexpr float kOutputGain = 0.5f;
+
+    float* ring = nullptr;
+    int maxDelay = 0; // frames
+    uint32_t mask = 0;
+    alignas(32) float excitation[kBlock * kStrings] = {};
+    alignas(32) float delayFrac[kStrings] = {};
+    alignas(32) float loss[kStrings] = {};
+    alignas(32) float lpCoef[kStrings] = {};
+    alignas(32) float apCoef[kStrings] = {};
+    alignas(32) float lp[kStrings] = {};
+    alignas(32) float apIn[kStrings] = {};
+    alignas(32) float apOut[kStrings] = {};
+    alignas(32) float panL[kStrings] = {};
+    alignas(32) float panR[kStrings] = {};
+    int delayInt[kStrings] = {};
+    int onset[kStrings] = {};
+    float burst[kStrings] = {};
+    float burstStep = 0.01f;
+    float bridge = 0.0f;
+    uint32_t writePos = 0;
+    bool exciting = false;
+    bool tuningDirty = true;
+    float sampleRate = 48000.0f;
+    float frequency = 440.0f;
+    float harmonics = 0.5f;
+    float timbre = 0.5f;
+    float morph = 0.5f;
+    float level = 1.0f;
+    uint32_t rng = 0x2545f491u;
+    Oversampler saturatorL, saturatorR;
+};
@@ -2,11 +2,25 @@
 // Plaits "String" engine: plucked/bowed/struck string physical modeling
 #pragma once
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include "exciter.h"
+#include "oversampler.h"
 
 
 class StringEngine {
 public:
+    static constexpr const char* kName = "String/Resonator";
+    static constexpr bool kRandomStart = true; // excited by noise
+    // Both delay lines, long enough for the 20 Hz floor at sampleRate
+    static constexpr std::size_t bufferSize(float sampleRate) { return 2 * std::size_t(delayFrames(sampleRate)); }
+    void setBuffer(float* memory, float sampleRate) {
+        maxDelay = delayFrames(sampleRate);
+        delayL = memory;
+        delayR = memory + maxDelay;
+        updateDelay();
+    }
     void setLevel(float l) { level = l; }
     void setLfoFreq(float f) { lfoFreq = f; }
     void setLfoWave(float w) { lfoWave = w; }
@@ -14,13 +28,22 @@ public:
     void setADSR(float a, float d, float s, float r) { attack = a; decay = d; sustain = s; release = r; }
     void gate(bool g) { gateOn = g; }
     // Stereo process with level
-    void process(float& left, float& right) {
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
     // Gate ignored: always output sound
-        float l, r;
-        processCore(l, r);
-        left = l * level;
-        right = r * level;
+        for (uint32_t i = 0; i < n; ++i) processCore(left[i], right[i]);
+        saturatorL.process(left, n, [](float x) { return std::tanh(x); });
+        saturatorR.process(right, n, [](float x) { return std::tanh(x); });
+        for (uint32_t i = 0; i < n; ++i) {
+            float driftL = 1.0f + ((float)rand()/RAND_MAX-0.5f)*0.001f;
+            float driftR = 1.0f + ((float)rand()/RAND_MAX-0.5f)*0.001f;
+            float noiseL = ((float)rand() / RAND_MAX - 0.5f) * 0.002f;
+            float noiseR = ((float)rand() / RAND_MAX - 0.5f) * 0.002f;
+            left[i] = (left[i] * driftL + noiseL) * level;
+            right[i] = (right[i] * driftR + noiseR) * level;
+        }
     }
+    void setOversampling(int factor) { saturatorL.setFactor(factor); saturatorR.setFactor(factor); }
     // Parameter getters
     float getSampleRate() const { return sampleRate; }
     float getFrequency() const { return frequency; }
@@ -34,47 +57,29 @@ public:
     void getADSR(float& a, float& d, float& s, float& r) const { a = attack; d = decay; s = sustain; r = release; }
     bool isGateOn() const { return gateOn; }
 public:
-    void setSampleRate(float sr) { sampleRate = sr; }
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; updateDelay(); } }
     void setFrequency(float freq) {
-        frequency = std::max(20.0f, std::min(freq, sampleRate / 4.0f)); // Clamp to safe range
+        freq = std::max(20.0f, std::min(freq, sampleRate / 4.0f)); // Clamp to safe range
+        if (freq == frequency) return;
+        frequency = freq;
         updateDelay();
     }
-    void setHarmonics(float h) { harmonics = h; updateDamping(); }
+    void setHarmonics(float h) { if (h != harmonics) { harmonics = h; updateDamping(); } }
     void setTimbre(float t) { timbre = t; }
     void setMorph(float m) { morph = m; }
     void reset() {
         for (int i=0; i<maxDelay; ++i) { delayL[i] = 0.0f; delayR[i] = 0.0f; }
         idxL = idxR = 0;
-        excitePhase = 0.0f;
-        bowLP = 0.0f;
+        exciter.reset();
         apL = apR = 0.0f;
-        delayLenL = 440;
-        delayLenR = 440;
+        saturatorL.reset(); saturatorR.reset();
+        updateDelay();
     }
     // Core stereo process
     void processCore(float& left, float& right) {
-        // Excitation: morph between pluck, bow, strike, and position
-        float exc = 0.0f;
-        float excType = morph; // 0=pluck, 0.5=bow, 1=strike
-        float pos = timbre; // excitation position
-        if (excType < 0.33f) {
-            // Pluck: short burst of noise
-            if (excitePhase < 1.0f) {
-                exc = ((float)rand() / RAND_MAX - 0.5f) * 2.0f * (1.0f - excitePhase);
-                excitePhase += 1.0f / (sampleRate * 0.002f + pos * 0.02f * sampleRate);
-            }
-        } else if (excType < 0.66f) {
-            // Bow: continuous noise with lowpass
-            exc = ((float)rand() / RAND_MAX - 0.5f) * 0.4f;
-            bowLP = bowLP * 0.96f + exc * 0.04f;
-            exc = bowLP;
-        } else {
-            // Strike: short, sharp burst
-            if (excitePhase < 0.5f) {
-                exc = ((float)rand() / RAND_MAX - 0.5f) * 3.0f * (1.0f - 2.0f * excitePhase);
-                excitePhase += 1.0f / (sampleRate * 0.001f + pos * 0.01f * sampleRate);
-            }
-        }
+        // Excitation: morph between pluck, bow, strike; timbre is the position
+        float pos = timbre;
+        float exc = exciter.process(morph, pos, sampleRate);
         // Stereo: two slightly detuned/offset delay lines for width
         float apCoef = 0.5f * (0.2f + 0.8f * harmonics);
         int safeLenL = std::max(1, delayLenL);
@@ -103,17 +108,9 @@ public:
         idxL = (idxL + 1) % safeLenL;
         idxR = (idxR + 1) % safeLenR;
         float width = 0.7f + 0.3f * pos;
-        left = outL * width;
-        right = outR * width;
-        float driftL = 1.0f + ((float)rand()/RAND_MAX-0.5f)*0.001f;
-        float driftR = 1.0f + ((float)rand()/RAND_MAX-0.5f)*0.001f;
-        left = std::tanh(left * 1.1f) * driftL;
-        right = std::tanh(right * 1.1f) * driftR;
-        float noiseL = ((float)rand() / RAND_MAX - 0.5f) * 0.002f;
-        float noiseR = ((float)rand() / RAND_MAX - 0.5f) * 0.002f;
-        left += noiseL;
-        right += noiseR;
-        if (excitePhase > 1.0f) excitePhase = 0.0f;
+        // Driven into the output saturation by processBlock()
+        left = outL * width * 1.1f;
+        right = outR * width * 1.1f;
     }
 private:
     float level = 1.0f;
@@ -122,6 +119,7 @@ private:
     float lfoVar = 0.0f;
     float attack = 0.01f, decay = 0.1f, sustain = 0.8f, release = 0.2f;
     bool gateOn = false;
+    static constexpr int delayFrames(float sampleRate) { return int(sampleRate / 21.0f) + 1; }
     void updateDelay() {
         delayLenL = std::max(8, int(sampleRate / (frequency + 1.0f)));
         delayLenR = std::max(8, int(sampleRate / (frequency * 0.997f + 1.0f)));
@@ -136,15 +134,15 @@ private:
     float harmonics = 0.0f;
     float timbre = 0.5f;
     float morph = 0.0f;
-    static constexpr int maxDelay = 2048;
-    float delayL[maxDelay] = {0};
-    float delayR[maxDelay] = {0};
+    int maxDelay = 0;
+    float* delayL = nullptr;
+    float* delayR = nullptr;
     int delayLenL = 440;
     int delayLenR = 440;
     int idxL = 0;
     int idxR = 0;
     float damping = 0.98f;
-    float excitePhase = 0.0f;
-    float bowLP = 0.0f;
+    StringExciter exciter;
     float apL = 0.0f, apR = 0.0f;
+    Oversampler saturatorL, saturatorR;
 };
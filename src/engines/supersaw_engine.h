@@ -1,10 +1,14 @@
 // supersaw_engine.h
 #pragma once
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include "oversampler.h"
 
 class SuperSawEngine {
 public:
+    static constexpr const char* kName = "SuperSaw";
+    static constexpr bool kRandomStart = true; // reset() draws random phases
     void setSampleRate(float sr) { sampleRate = sr; }
     void setFrequency(float freq) { frequency = freq; }
     void setHarmonics(float h) { harmonics = h; }
@@ -18,31 +22,36 @@ public:
     void gate(bool g) { gateOn = g; }
     void reset() {
         for (int i = 0; i < 9; ++i) phase[i] = float(rand()) / RAND_MAX;
+        saturatorL.reset(); saturatorR.reset();
     }
+    void setOversampling(int factor) { saturatorL.setFactor(factor); saturatorR.setFactor(factor); }
     // Stereo output
-    void process(float& left, float& right) {
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
     // Gate ignored: always output sound
         static const float detune[9] = {0.0f, -0.018f, 0.018f, -0.045f, 0.045f, -0.09f, 0.09f, -0.14f, 0.14f};
         static const float pan[9] = {0.0f, -0.7f, 0.7f, -0.4f, 0.4f, -1.0f, 1.0f, -0.2f, 0.2f};
         float spread = 0.2f + 0.8f * timbre;
         float detuneAmt = 0.04f + 0.12f * harmonics;
-        float sumL = 0.0f, sumR = 0.0f;
-        for (int i = 0; i < 9; ++i) {
-            float freq = frequency * (1.0f + detune[i] * detuneAmt);
-            float inc = freq / sampleRate;
-            phase[i] += inc;
-            if (phase[i] >= 1.0f) phase[i] -= 1.0f;
-            float saw = 2.0f * (phase[i] - 0.5f);
-            float p = 0.5f + 0.5f * pan[i] * spread;
-            sumL += saw * (1.0f - p);
-            sumR += saw * p;
+        for (uint32_t s = 0; s < n; ++s) {
+            float sumL = 0.0f, sumR = 0.0f;
+            for (int i = 0; i < 9; ++i) {
+                float freq = frequency * (1.0f + detune[i] * detuneAmt);
+                float inc = freq / sampleRate;
+                phase[i] += inc;
+                if (phase[i] >= 1.0f) phase[i] -= 1.0f;
+                float saw = 2.0f * (phase[i] - 0.5f);
+                float p = 0.5f + 0.5f * pan[i] * spread;
+                sumL += saw * (1.0f - p);
+                sumR += saw * p;
+            }
+            float l = (sumL / 6.0f) * level + ((float)rand() / RAND_MAX - 0.5f) * 0.002f;
+            float r = (sumR / 6.0f) * level + ((float)rand() / RAND_MAX - 0.5f) * 0.002f;
+            left[s] = l * 0.8f;
+            right[s] = r * 0.8f;
         }
-        left = (sumL / 6.0f) * level;
-        right = (sumR / 6.0f) * level;
-        left += ((float)rand() / RAND_MAX - 0.5f) * 0.002f;
-        right += ((float)rand() / RAND_MAX - 0.5f) * 0.002f;
-        left = std::tanh(left * 0.8f);
-        right = std::tanh(right * 0.8f);
+        saturatorL.process(left, n, [](float x) { return std::tanh(x); });
+        saturatorR.process(right, n, [](float x) { return std::tanh(x); });
     }
     // Parameter getters
     float getSampleRate() const { return sampleRate; }
@@ -69,4 +78,5 @@ private:
     float attack = 0.01f, decay = 0.1f, sustain = 0.8f, release = 0.2f;
     bool gateOn = false;
     float phase[9] = {0};
+    Oversampler saturatorL, saturatorR;
 };
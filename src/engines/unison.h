@@ -0,0 +1,165 @@
+// unison.h - Detuned, panned stack of copies of any engine
+// Unison<E, N> holds N copies of E side by side and plays the first `voices`
+// of them, spread symmetrically over +-detune and across the stereo field.
+// Setters reach every copy, so a voice joining the stack already has the
+// current controls. At any Detune the stack is about as loud as one voice.
+// With one voice the engine renders straight into the output, bit for bit as
+// without the wrapper.
+//
+// Cost: each extra voice is one more full render of the engine plus a
+// vectorized multiply-add of its block into the mix, so N voices cost about N
+// times the engine. Measured per extra voice at 261.63 Hz, 2x Quality, SSE2:
+// Saw 26 ns/sample, Wavefolder 41, Modal 72, SuperSaw 82, Additive 395.
+//
+// The copies live in one array, but each renders through its own block
+// kernel: the engines' kernels are serial per voice (oscillator phases,
+// filter states), and lane-parallel stacking is left to engines built as
+// banks, like Modal and String Bank.
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "engine_traits.h"
+#include "rate_scale.h"
+
+static constexpr int kMaxUnison = 8;
+// Copies are kept inside the registry slot and their buffers in its pool.
+// Each stack is held to kUnisonBudget at 48 kHz, so engines with large
+// buffers get fewer copies (String 3, String Bank and Granular 1) and the
+// pool stays about the size of one String Bank ring
+static constexpr std::size_t kUnisonBudget = 64 * 1024;
+
+// Bytes one copy of E occupies at 48 kHz, its buffer included
+template <typename E>
+constexpr std::size_t unisonFootprint() {
+    if constexpr (HasBuffer<E>::value) return sizeof(E) + E::bufferSize(kReferenceRate) * sizeof(float);
+    else return sizeof(E);
+}
+
+template <typename E>
+constexpr int unisonVoices() {
+    const std::size_t fit = kUnisonBudget / unisonFootprint<E>();
+    return fit < 1 ? 1 : (fit > std::size_t(kMaxUnison) ? kMaxUnison : int(fit));
+}
+
+template <typename E, int N>
+class Unison {
+public:
+    static constexpr const char* kName = E::kName;
+    static constexpr int kVoices = N;
+    static constexpr int kBlock = 64;
+
+    void setSampleRate(float sr) { for (E& v : copies) v.setSampleRate(sr); }
+    void setFrequency(float f) {
+        frequency = f;
+        retune();
+    }
+    void setHarmonics(float h) { for (E& v : copies) v.setHarmonics(h); }
+    void setTimbre(float t) { for (E& v : copies) v.setTimbre(t); }
+    void setMorph(float m) { for (E& v : copies) v.setMorph(m); }
+    void setOversampling(int factor) {
+        if constexpr (HasOversampling<E>::value) for (E& v : copies) v.setOversampling(factor);
+    }
+    void trigger() {
+        if constexpr (HasTrigger<E>::value) for (int k = 0; k < voices; ++k) copies[k].trigger();
+    }
+    void reset() { for (E& v : copies) v.reset(); }
+
+    // Buffers of all N copies, each starting on a 64-byte boundary
+    static constexpr std::size_t bufferSize(float sampleRate) { return N * bufferStride(sampleRate); }
+    void setBuffer(float* memory, float sampleRate) {
+        if constexpr (HasBuffer<E>::value)
+            for (int k = 0; k < N; ++k) copies[k].setBuffer(memory + k * bufferStride(sampleRate), sampleRate);
+    }
+
+    // count is clamped to 1..N; detune 0..1 spreads the copies up to +-25 cents
+    void setUnison(int count, float detune) {
+        count = std::clamp(count, 1, N);
+        // Idle copies kept their old state; start joining ones clean, and with
+        // them the playing ones where copies start alike, so the stack stays in phase
+        const int from = HasRandomStart<E>::value ? voices : 0;
+        if (count > voices) for (int k = from; k < count; ++k) copies[k].reset();
+        if (count == voices && detune == spread) return;
+        voices = count;
+        spread = detune;
+        retune();
+    }
+
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
+        if (voices == 1) {
+            render(copies[0], left, right, n);
+            return;
+        }
+        while (n > 0) {
+            const uint32_t count = std::min<uint32_t>(n, kBlock);
+            std::fill(left, left + count, 0.0f);
+            std::fill(right, right + count, 0.0f);
+            for (int k = 0; k < voices; ++k) {
+                render(copies[k], scratchL, scratchR, count);
+                const float gl = gainL[k], gr = gainR[k];
+                for (uint32_t i = 0; i < count; ++i) {
+                    left[i] += gl * scratchL[i];
+                    right[i] += gr * scratchR[i];
+                }
+            }
+            left += count;
+            right += count;
+            n -= count;
+        }
+    }
+
+private:
+    static void render(E& e, float* left, float* right, uint32_t n) {
+        if constexpr (HasProcessBlock<E>::value) {
+            e.processBlock(left, right, n);
+        } else {
+            for (uint32_t i = 0; i < n; ++i) e.process(left[i], right[i]);
+        }
+    }
+
+    static constexpr std::size_t bufferStride(float sampleRate) {
+        if constexpr (HasBuffer<E>::value) return (E::bufferSize(sampleRate) + 15) & ~std::size_t(15);
+        else return 0;
+    }
+
+    // Copy k sits at position -1..1 across the stack: pitch offset and pan
+    void retune() {
+        if (voices == 1) {
+            copies[0].setFrequency(frequency);
+            return;
+        }
+        float pan[N], coherent = 0.0f;
+        for (int k = 0; k < voices; ++k) {
+            const float position = 2.0f * float(k) / float(voices - 1) - 1.0f;
+            copies[k].setFrequency(frequency * std::exp2(position * spread * kMaxCents / 1200.0f));
+            pan[k] = 0.785398f * (1.0f + kWidth * position);
+            coherent += 1.414214f * std::cos(pan[k]);
+        }
+        // Detuned copies drift apart and add up in power. Copies started
+        // alike at one pitch stay in phase and add up in amplitude, sqrt(voices)
+        // louder, so the gain moves to the amplitude sum as Detune goes to 0.
+        // The pan law is symmetric: both channels get the same sums.
+        const float drift = HasRandomStart<E>::value ? 1.0f : std::min(spread / kCoherentSpread, 1.0f);
+        const float norm = drift / std::sqrt(float(voices)) + (1.0f - drift) / coherent;
+        for (int k = 0; k < voices; ++k) {
+            gainL[k] = norm * 1.414214f * std::cos(pan[k]);
+            gainR[k] = norm * 1.414214f * std::sin(pan[k]);
+        }
+    }
+
+    static constexpr float kMaxCents = 25.0f;
+    // Detune below which copies beat too slowly to count as uncorrelated:
+    // +-2.5 cents, under a beat per second at middle C
+    static constexpr float kCoherentSpread = 0.1f;
+    static constexpr float kWidth = 0.8f;
+
+    E copies[N];
+    alignas(16) float scratchL[kBlock];
+    alignas(16) float scratchR[kBlock];
+    float gainL[N] = {}, gainR[N] = {};
+    float frequency = 440.0f;
+    float spread = 0.0f;
+    int voices = 1;
+};
@@ -1,20 +1,7 @@
 // virtual_analog_engine.h
 #pragma once
 #include <cmath>
-
-
-// PolyBLEP helper for band-limited saw/square
-inline float polyblep(float t, float dt) {
-    if (t < dt) {
-        float x = t / dt;
-        return x + x - x * x - 1.0f;
-    } else if (t > 1.0f - dt) {
-        float x = (t - 1.0f) / dt;
-        return x * x + x + x + 1.0f;
-    } else {
-        return 0.0f;
-    }
-}
+#include "minblep.h"
 
 
 class VirtualAnalogEngine {
@@ -24,26 +11,17 @@ public:
     void setHarmonics(float h) { harmonics = h; }
     void setTimbre(float t) { timbre = t; }
     void setMorph(float m) { morph = m; }
-    void reset() { phase = 0.0f; gateOn = false; }
+    void reset() { osc.reset(); blep.reset(); gateOn = false; }
     void gate(bool on) { gateOn = on; }
     // Plaits-style process: morph = saw <-> square, timbre = wavefold, harmonics = brightness
     float process() {
         if (!gateOn) return 0.0f;
         float phaseInc = frequency / sampleRate;
-        phase += phaseInc;
-        if (phase >= 1.0f) phase -= 1.0f;
-        // Band-limited saw
-        float saw = 2.0f * (phase - 0.5f);
-        saw -= polyblep(phase, phaseInc);
-        // Band-limited square
-        float pw = 0.5f + 0.48f * timbre; // 0.5-0.98
-        float square = (phase < pw ? 1.0f : -1.0f);
-        square += polyblep(phase, phaseInc);
-        float t2 = phase + 1.0f - pw;
-        if (t2 >= 1.0f) t2 -= 1.0f;
-        square -= polyblep(t2, phaseInc);
-        // Morph: crossfade saw <-> square
-        float out = (1.0f - morph) * saw + morph * square;
+        // Band-limited saw/square, morph: crossfade saw <-> square
+        osc.setShape(1.0f - morph, morph, 0.0f);
+        osc.setPulseWidth(0.5f + 0.48f * timbre); // 0.5-0.98
+        float out = osc.process(phaseInc, blep, 0);
+        blep.apply(&out, 1);
         // Wavefolding (timbre): Plaits-style
         float folds = 1.0f + 4.0f * timbre; // up to 5 folds
         for (int i = 0; i < int(folds); ++i) {
@@ -63,19 +41,8 @@ private:
     float harmonics = 0.0f;
     float timbre = 0.5f;
     float morph = 0.0f;
-    float phase = 0.0f;
+    BlepOscillator osc;
+    BlepBuffer blep;
     float lastOut = 0.0f;
     bool gateOn = false;
-    // PolyBLEP helper
-    static float polyblep(float t, float dt) {
-        if (t < dt) {
-            float x = t / dt;
-            return x + x - x * x - 1.0f;
-        } else if (t > 1.0f - dt) {
-            float x = (t - 1.0f) / dt;
-            return x * x + x + x + 1.0f;
-        } else {
-            return 0.0f;
-        }
-    }
 };
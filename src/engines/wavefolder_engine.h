@@ -0,0 +1,178 @@
+// wavefolder_engine.h
+// Waveshaping/wavefolding engine after Plaits' waveshaper:
+//   harmonics: folder curve, from smooth cubic folds (0) to sharp triangular
+//              reflections (1)
+//   timbre:    fold amount, a drive of 1 to 8 into the folder
+//   morph:     asymmetry of the source, triangle (0) to saw (1)
+// The folder is antialiased with first-order ADAA: instead of f(x[n]) each
+// sample outputs the mean of f over the segment from x[n-1] to x[n],
+// (F(x[n]) - F(x[n-1])) / (x[n] - x[n-1]) with F the antiderivative of f. This
+// lowpasses the partials the folds create before they are sampled. Both curves reflect with period 4, so F is
+// periodic too and stays well conditioned however hard the drive. A block is
+// rendered in straight-line passes (source, F, difference quotient) that the
+// compiler can vectorize.
+// ADAA alone leaves loud aliases on high notes at full drive (see
+// the engine README), so above 1x Quality the source and the folder, ADAA
+// included, run at the Quality rate and only the result is decimated. The
+// source is made there rather than upsampled: the upsampler's transition
+// band passes images of its top partials, which the folds would spread
+// across the audio band.
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "minblep.h"
+#include "oversampler.h"
+#include "rate_scale.h"
+
+class WavefolderEngine {
+public:
+    static constexpr const char* kName = "Wavefolder";
+
+    void setSampleRate(float sr) { if (sr != sampleRate) { sampleRate = sr; dcCoef = rateCoef(0.995f, sr); } }
+    void setFrequency(float freq) { frequency = freq; }
+    void setHarmonics(float h) { harmonics = std::clamp(h, 0.0f, 1.0f); }
+    void setTimbre(float t) { targetDrive = 1.0f + 7.0f * std::clamp(t, 0.0f, 1.0f); }
+    void setMorph(float m) { morph = std::clamp(m, 0.0f, 1.0f); }
+    void setLevel(float l) { level = l; }
+    void setOversampling(int factor) { oversampler.setFactor(factor); }
+    void reset() {
+        osc.reset(); blep.reset(); oversampler.reset();
+        drive = targetDrive;
+        xPrev = 0.0f; fPrev = 0.0f;
+        dcIn = dcOut = 0.0f;
+    }
+
+    void process(float& left, float& right) { processBlock(&left, &right, 1); }
+    void processBlock(float* left, float* right, uint32_t n) {
+        osc.setShape(morph, 0.0f, 1.0f - morph);
+        const float phaseInc = frequency / sampleRate;
+        const Curve curve(harmonics);
+        const int factor = oversampler.getFactor();
+        while (n > 0) {
+            const int count = int(std::min<uint32_t>(n, BlepBuffer::kMaxBlock));
+            // Drive ramps across the block so timbre sweeps don't step
+            const float driveStep = (targetDrive - drive) / float(count);
+            if (factor > 1) {
+                renderOversampled(left, count, phaseInc / float(factor), driveStep / float(factor), curve);
+            } else {
+                renderBlock(left, count, phaseInc, driveStep, curve);
+            }
+            drive = targetDrive;
+            // Saw asymmetry folds into DC; block it
+            for (int i = 0; i < count; ++i) {
+                const float y = left[i] - dcIn + dcCoef * dcOut;
+                dcIn = left[i];
+                dcOut = y;
+                left[i] = y * kOutputGain * level;
+                right[i] = left[i];
+            }
+            left += count;
+            right += count;
+            n -= uint32_t(count);
+        }
+    }
+
+private:
+    struct Curve;
+
+    // count <= BlepBuffer::kMaxBlock samples at the base rate, in straight-line passes
+    void renderBlock(float* out, int count, float phaseInc, float driveStep, const Curve& curve) {
+        // x[0] is the last input of the previous block
+        float x[BlepBuffer::kMaxBlock + 1];
+        float F[BlepBuffer::kMaxBlock + 1];
+        x[0] = xPrev;
+        F[0] = fPrev;
+        for (int i = 0; i < count; ++i) out[i] = osc.process(phaseInc, blep, i);
+        blep.apply(out, count);
+        for (int i = 0; i < count; ++i)
+            x[i + 1] = std::clamp(out[i] * (drive + driveStep * float(i + 1)), -kMaxInput, kMaxInput);
+        for (int i = 1; i <= count; ++i) F[i] = curve.integral(x[i]);
+        for (int i = 0; i < count; ++i) out[i] = quotient(curve, x[i], x[i + 1], F[i], F[i + 1]);
+        xPrev = x[count];
+        fPrev = F[count];
+    }
+
+    // count base-rate samples made at the Quality rate; phaseInc and
+    // driveStep are per oversampled sample
+    void renderOversampled(float* out, int count, float phaseInc, float driveStep, const Curve& curve) {
+        oversampler.render(out, uint32_t(count), [&](float* hi, uint32_t len) {
+            for (uint32_t start = 0; start < len; start += BlepBuffer::kMaxBlock) {
+                const int m = int(std::min<uint32_t>(len - start, BlepBuffer::kMaxBlock));
+                float* block = hi + start;
+                for (int i = 0; i < m; ++i) block[i] = osc.process(phaseInc, blep, i);
+                blep.apply(block, m);
+                for (int i = 0; i < m; ++i) {
+                    const float x = std::clamp(block[i] * (drive + driveStep * float(start + uint32_t(i) + 1)),
+                                               -kMaxInput, kMaxInput);
+                    const float f = curve.integral(x);
+                    block[i] = quotient(curve, xPrev, x, fPrev, f);
+                    xPrev = x;
+                    fPrev = f;
+                }
+            }
+        });
+    }
+
+    // Mean of the curve between inputs a and b
+    static float quotient(const Curve& curve, float a, float b, float fa, float fb) {
+        const float dx = b - a;
+        // Near-equal inputs cancel in F; the segment midpoint is exact to O(dx^2)
+        const float mid = curve.shape(0.5f * (a + b));
+        return std::fabs(dx) > kMinStep ? (fb - fa) / dx : mid;
+    }
+
+    // Blend of two folders sharing one reflection: inside [-1, 1] the input t
+    // is shaped by s(t) = (1 - h)(1.5t - 0.5t^3) + h t, and outside it the
+    // input reflects off +-1 like a triangle wave of period 4. With
+    // G(t) = integral of s, over one period F(x) = G(t) on the rising half and
+    // 2 G(1) - G(t) on the falling half, so F is continuous and periodic.
+    struct Curve {
+        explicit Curve(float h) : smooth(1.0f - h), sharp(h), peak(2.0f * G(1.0f)) {}
+
+        // Reflect x into t in [-1, 1]; rising is false on the falling half
+        static float reflect(float x, bool& rising) {
+            float u = x + (kOffset + 1.0f); // positive, so truncation floors
+            u -= 4.0f * float(int(u * 0.25f));
+            const float p = u - 1.0f; // [-1, 3)
+            rising = p <= 1.0f;
+            return rising ? p : 2.0f - p;
+        }
+        float shape(float x) const {
+            bool rising;
+            const float t = reflect(x, rising);
+            return t * (smooth * (1.5f - 0.5f * t * t) + sharp);
+        }
+        float integral(float x) const {
+            bool rising;
+            const float t = reflect(x, rising);
+            const float g = G(t);
+            return rising ? g : peak - g;
+        }
+        float G(float t) const {
+            const float t2 = t * t;
+            return t2 * (smooth * (0.75f - 0.125f * t2) + 0.5f * sharp);
+        }
+
+        float smooth, sharp, peak;
+    };
+
+    // Whole periods added before reflecting; keeps the wrapped value positive
+    // for any clamped input with float precision to spare
+    static constexpr float kOffset = 16.0f;
+    static constexpr float kMaxInput = 12.0f;
+    static constexpr float kMinStep = 1e-3f;
+    static constexpr float kOutputGain = 0.8f;
+
+    BlepOscillator osc;
+    BlepBuffer blep;
+    Oversampler oversampler;
+    float sampleRate = 48000.0f;
+    float frequency = 440.0f;
+    float harmonics = 0.5f;
+    float morph = 0.0f;
+    float targetDrive = 4.5f, drive = 4.5f;
+    float xPrev = 0.0f, fPrev = 0.0f;
+    float dcIn = 0.0f, dcOut = 0.0f, dcCoef = 0.995f;
+    float level = 1.0f;
+};
@@ -0,0 +1,148 @@
+// limiter.hpp - Lookahead true-peak limiter for the end of the chain
+// Peaks are measured on a 4x polyphase interpolation of the input (BS.1770
+// style), held over the lookahead window by a monotonic-deque sliding maximum
+// (O(1) amortized per sample) and turned into a gain that a box filter of the
+// same length smooths, so the gain has fully settled by the time the delayed
+// peak reaches the output. Gain is linked across channels. All state is
+// fixed-size; nothing allocates.
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+class TruePeakLimiter {
+public:
+    static constexpr int kPhases = 4;
+    static constexpr int kTaps = 24;                 // per phase
+    static constexpr int kDetectorDelay = kTaps / 2; // samples
+    static constexpr int kMaxWindow = 256;           // 1 ms lookahead up to 192 kHz
+    static constexpr int kDelaySize = 512;           // power of two > kMaxWindow + kDetectorDelay
+
+    TruePeakLimiter() { buildInterpolator(); }
+
+    // Sizes the lookahead window for this rate and clears the state. Returns
+    // the latency in samples.
+    uint32_t prepare(float sampleRate, float lookaheadMs = 1.0f, float releaseMs = 80.0f) {
+        window = std::clamp(int(std::lround(sampleRate * lookaheadMs * 0.001f)), 1, kMaxWindow);
+        releaseCoef = std::exp(-1.0f / (sampleRate * releaseMs * 0.001f));
+        reset();
+        return getLatency();
+    }
+    uint32_t getLatency() const { return uint32_t(window - 1 + kDetectorDelay); }
+
+    void setCeiling(float dBTP) { ceiling = std::pow(10.0f, dBTP / 20.0f); }
+
+    void reset() {
+        std::fill(histL, histL + 2 * kTaps, 0.0f);
+        std::fill(histR, histR + 2 * kTaps, 0.0f);
+        std::fill(delayL, delayL + kDelaySize, 0.0f);
+        std::fill(delayR, delayR + kDelaySize, 0.0f);
+        histPos = 0;
+        delayPos = 0;
+        resetGain();
+    }
+
+    // Delays by getLatency() and limits. Disabled, the delay (and so the
+    // reported latency) stays but the detector is skipped.
+    void process(float* left, float* right, uint32_t n, bool enabled) {
+        if (enabled && !wasEnabled) resetGain();
+        wasEnabled = enabled;
+        const uint32_t latency = getLatency();
+        for (uint32_t i = 0; i < n; ++i) {
+            // Newest-first history, mirrored so the taps are always contiguous
+            histPos = (histPos + kTaps - 1) % kTaps;
+            histL[histPos] = histL[histPos + kTaps] = left[i];
+            histR[histPos] = histR[histPos + kTaps] = right[i];
+            delayL[delayPos] = left[i];
+            delayR[delayPos] = right[i];
+            const uint32_t readPos = (delayPos - latency) & (kDelaySize - 1);
+            delayPos = (delayPos + 1) & (kDelaySize - 1);
+            if (!enabled) {
+                left[i] = delayL[readPos];
+                right[i] = delayR[readPos];
+                continue;
+            }
+            const float gain = nextGain(truePeak(histL + histPos, histR + histPos));
+            left[i] = delayL[readPos] * gain;
+            right[i] = delayR[readPos] * gain;
+        }
+    }
+
+private:
+    // Windowed-sinc prototype; phase 0 is the unit impulse, i.e. the sample
+    // kDetectorDelay back, phases 1..3 the points between it and the next one
+    void buildInterpolator() {
+        const int length = kPhases * kTaps;
+        const int center = kPhases * kDetectorDelay;
+        for (int m = 0; m < length; ++m) {
+            const double t = double(m - center) / kPhases;
+            const double sinc = t == 0.0 ? 1.0 : std::sin(M_PI * t) / (M_PI * t);
+            const double w = 0.5 + 0.5 * std::cos(M_PI * double(m - center) / double(center + 1));
+            coefs[m % kPhases][m / kPhases] = float(sinc * w);
+        }
+    }
+
+    float truePeak(const float* l, const float* r) const {
+        float peak = std::max(std::fabs(l[kDetectorDelay]), std::fabs(r[kDetectorDelay]));
+        for (int p = 1; p < kPhases; ++p) {
+            float yl = 0.0f, yr = 0.0f;
+            for (int k = 0; k < kTaps; ++k) {
+                yl += coefs[p][k] * l[k];
+                yr += coefs[p][k] * r[k];
+            }
+            peak = std::max(peak, std::max(std::fabs(yl), std::fabs(yr)));
+        }
+        return peak;
+    }
+
+    float nextGain(float peak) {
+        // Sliding maximum over the last `window` peaks: the deque keeps
+        // strictly decreasing values, so its front is the window maximum
+        if (dequeSize > 0 && dequeTime[dequeHead] <= time - window) {
+            dequeHead = (dequeHead + 1) % kMaxWindow;
+            --dequeSize;
+        }
+        while (dequeSize > 0 && dequeValue[back()] <= peak) --dequeSize;
+        const int slot = (dequeHead + dequeSize) % kMaxWindow;
+        dequeValue[slot] = peak;
+        dequeTime[slot] = time;
+        ++dequeSize;
+        ++time;
+        const float maxPeak = dequeValue[dequeHead];
+        const float target = maxPeak > ceiling ? ceiling / maxPeak : 1.0f;
+        // Instant attack keeps the box average at or below every target it covers
+        held = target < held ? target : target + (held - target) * releaseCoef;
+        boxSum += double(held) - double(box[boxPos]);
+        box[boxPos] = held;
+        boxPos = (boxPos + 1) % window;
+        return float(boxSum / double(window));
+    }
+    int back() const { return (dequeHead + dequeSize - 1) % kMaxWindow; }
+
+    void resetGain() {
+        std::fill(box, box + kMaxWindow, 1.0f);
+        boxSum = double(window);
+        boxPos = 0;
+        held = 1.0f;
+        dequeHead = dequeSize = 0;
+        time = 0;
+    }
+
+    float coefs[kPhases][kTaps];
+    float histL[2 * kTaps] = {}, histR[2 * kTaps] = {};
+    int histPos = 0;
+    float delayL[kDelaySize] = {}, delayR[kDelaySize] = {};
+    uint32_t delayPos = 0;
+    float dequeValue[kMaxWindow];
+    int64_t dequeTime[kMaxWindow];
+    int dequeHead = 0, dequeSize = 0;
+    int64_t time = 0;
+    float box[kMaxWindow];
+    double boxSum = 0.0;
+    int boxPos = 0;
+    float held = 1.0f;
+    float ceiling = 1.0f;
+    float releaseCoef = 0.999f;
+    int window = 48;
+    bool wasEnabled = false;
+};
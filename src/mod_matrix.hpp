@@ -0,0 +1,76 @@
+// mod_matrix.hpp - Block-rate modulation matrix
+// Routes are folded into a dense source x destination depth table whenever a
+// route parameter changes. evaluate() then runs once per block: one multiply-add
+// per source over all destinations at once, so any number of routes costs the
+// same handful of vector operations and nothing is updated per sample.
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+class ModMatrix {
+public:
+    enum Source {
+        kSourceLfo,      // -1..1
+        kSourceEnvelope, // 0..1
+        kSourceVelocity, // 0..1, last note-on
+        kSourceModWheel, // 0..1, CC 1
+        kSourceCount
+    };
+
+    // Offsets are in the destination's normalized 0..1 range; Level is
+    // relative gain (1 + offset)
+    enum Destination {
+        kDestHarmonics,
+        kDestTimbre,
+        kDestMorph,
+        kDestCutoff,
+        kDestLevel,
+        kDestDelay,
+        kDestChorus,
+        kDestReverb,
+        kDestCount
+    };
+
+    static constexpr int kRoutes = 4;
+
+    static const char* sourceName(int source) {
+        static const char* const kNames[kSourceCount] = { "LFO", "Envelope", "Velocity", "Mod Wheel" };
+        return kNames[std::clamp(source, 0, int(kSourceCount) - 1)];
+    }
+
+    // Route destination parameters use 0 for "Off" and dest + 1 otherwise
+    static const char* destinationName(int dest) {
+        static const char* const kNames[kDestCount + 1] = {
+            "Off", "Harmonics", "Timbre", "Morph", "Cutoff", "Level", "Delay", "Chorus", "Reverb"
+        };
+        return kNames[std::clamp(dest, 0, int(kDestCount))];
+    }
+
+    void clear() {
+        std::fill(&depth[0][0], &depth[0][0] + kSourceCount * kDestCount, 0.0f);
+        active = 0;
+    }
+
+    // Several routes may share a source and destination; their depths add up
+    void addRoute(int source, int dest, float amount) {
+        if (source < 0 || source >= kSourceCount || dest < 0 || dest >= kDestCount || amount == 0.0f) return;
+        depth[source][dest] += amount;
+        active |= 1u << dest;
+    }
+
+    bool targets(Destination dest) const { return (active >> dest) & 1u; }
+    bool targetsAny(uint32_t destMask) const { return (active & destMask) != 0; }
+
+    void evaluate(const float* sources, float* offsets) const {
+        alignas(32) float sum[kDestCount] = {};
+        for (int s = 0; s < kSourceCount; ++s) {
+            const float v = sources[s];
+            for (int d = 0; d < kDestCount; ++d) sum[d] += depth[s][d] * v;
+        }
+        std::copy(sum, sum + kDestCount, offsets);
+    }
+
+private:
+    alignas(32) float depth[kSourceCount][kDestCount] = {};
+    uint32_t active = 0;
+};
@@ -7,6 +7,7 @@ class MoogFilter {
 public:
     MoogFilter(float sampleRate) : sampleRate(sampleRate) { reset(); }
     void setCutoff(float fc) {
+        if (fc == cutoff && G != 0.0f) return; // coefficients still valid
         cutoff = fc;
         float wd = 2.0f * M_PI * cutoff;
         float T = 1.0f / sampleRate;
@@ -14,6 +15,13 @@ public:
         g = wa * T / 2.0f;
         G = g / (1.0f + g);
     }
+    // Runs at the oversampled rate when the plugin oversamples it
+    void setSampleRate(float sr) {
+        if (sr == sampleRate) return;
+        sampleRate = sr;
+        G = 0.0f; // force setCutoff() to recompute
+        setCutoff(cutoff);
+    }
     void setResonance(float r) { resonance = r * 4.0f; } // 0..1 mapped to 0..4
     void reset() {
         for (int i = 0; i < 4; ++i) z[i] = 0.0f;
@@ -0,0 +1,46 @@
+// param_store.hpp - Lock-free parameter handoff to the audio thread
+// Host/UI threads call set(); run() calls consume() once per block and only
+// sees the parameters that changed since the previous block.
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+template <uint32_t N>
+class ParamStore {
+public:
+    ParamStore() {
+        for (uint32_t i = 0; i < N; ++i) values[i].store(0.0f, std::memory_order_relaxed);
+        for (uint32_t w = 0; w < kWords; ++w) dirty[w].store(0, std::memory_order_relaxed);
+    }
+
+    // Any thread. The value is stored before the dirty bit is published, so a
+    // consumer that sees the bit also sees this value (or a newer one).
+    void set(uint32_t index, float value) {
+        if (index >= N) return;
+        values[index].store(value, std::memory_order_relaxed);
+        dirty[index >> 5].fetch_or(1u << (index & 31), std::memory_order_release);
+    }
+
+    float get(uint32_t index) const {
+        return index < N ? values[index].load(std::memory_order_relaxed) : 0.0f;
+    }
+
+    // Audio thread only: calls fn(index, value) for every parameter whose
+    // dirty bit was set, clearing the bits. Wait-free: one exchange per word.
+    template <typename Fn>
+    void consume(Fn&& fn) {
+        for (uint32_t w = 0; w < kWords; ++w) {
+            uint32_t bits = dirty[w].exchange(0, std::memory_order_acquire);
+            while (bits) {
+                const uint32_t index = w * 32 + uint32_t(__builtin_ctz(bits));
+                bits &= bits - 1;
+                fn(index, values[index].load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t kWords = (N + 31) / 32;
+    std::atomic<float> values[N];
+    std::atomic<uint32_t> dirty[kWords];
+};
@@ -0,0 +1,54 @@
+// spsc_ring.hpp - Wait-free single-producer, single-consumer ring
+// Neither side ever blocks or allocates: a full ring drops the new item and
+// counts it. Each index lives on its own cache line, and each side keeps a
+// cached copy of the other's index so a push is a few plain stores plus one
+// release store.
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+template <typename T, uint32_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer only. Returns false (and drops the record) when full.
+    bool push(const T& item) {
+        const uint32_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - cachedRead == Capacity) {
+            cachedRead = readIndex.load(std::memory_order_acquire);
+            if (head - cachedRead == Capacity) {
+                droppedCount.store(droppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        slots[head & (Capacity - 1)] = item;
+        writeIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false when empty.
+    bool pop(T& item) {
+        const uint32_t tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == cachedWrite) {
+            cachedWrite = writeIndex.load(std::memory_order_acquire);
+            if (tail == cachedWrite) return false;
+        }
+        item = slots[tail & (Capacity - 1)];
+        readIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Any thread
+    uint32_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    // Producer line
+    alignas(64) std::atomic<uint32_t> writeIndex{0};
+    uint32_t cachedRead = 0;
+    std::atomic<uint32_t> droppedCount{0};
+    // Consumer line
+    alignas(64) std::atomic<uint32_t> readIndex{0};
+    uint32_t cachedWrite = 0;
+    alignas(64) T slots[Capacity];
+};
@@ -0,0 +1,119 @@
+// stage_profiler.hpp - Per-stage CPU counters for run()
+// Compiled in only when SYNTH_PROFILE is defined (make PROFILE=true); otherwise
+// the SYNTH_PROFILE_* macros expand to nothing and the class is never touched.
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+enum ProfileStage {
+    kStageEngine,
+    kStageFilter,
+    kStageDelay,
+    kStageChorus,
+    kStageReverb,
+    kStageLimiter,
+    kNumProfileStages
+};
+
+static const char* const kProfileStageNames[kNumProfileStages] = {
+    "engine", "moog", "delay", "chorus", "reverb", "limiter"
+};
+
+class StageProfiler {
+public:
+    // log2 buckets: bucket b counts blocks that took [2^b, 2^(b+1)) ticks
+    static constexpr int kBuckets = 40;
+
+    static inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // RAII timer around one stage; ticks are summed until endBlock()
+    struct Scope {
+        Scope(StageProfiler& p, ProfileStage s) : profiler(p), stage(s), start(now()) {}
+        ~Scope() { profiler.pending[stage] += now() - start; }
+        StageProfiler& profiler;
+        ProfileStage stage;
+        uint64_t start;
+    };
+
+    // Audio thread only: fold this block's per-stage ticks into the histograms.
+    // Single writer, so plain load/store on the atomics is enough.
+    void endBlock() {
+        for (int s = 0; s < kNumProfileStages; ++s) {
+            const uint64_t ticks = pending[s];
+            pending[s] = 0;
+            int b = 0;
+            for (uint64_t t = ticks; t > 1 && b < kBuckets - 1; t >>= 1) ++b;
+            bump(histogram[s][b], 1);
+            bump(totalTicks[s], ticks);
+            if (ticks > maxTicks[s].load(std::memory_order_relaxed))
+                maxTicks[s].store(ticks, std::memory_order_relaxed);
+        }
+        blocks.store(blocks.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    struct Snapshot {
+        uint64_t blocks = 0;
+        uint64_t totalTicks[kNumProfileStages] = {};
+        uint64_t maxTicks[kNumProfileStages] = {};
+        uint64_t histogram[kNumProfileStages][kBuckets] = {};
+    };
+
+    // Any thread: wait-free copy of the counters. Individual counters may be
+    // one block apart from each other, which is fine for profiling.
+    Snapshot snapshot() const {
+        Snapshot snap;
+        snap.blocks = blocks.load(std::memory_order_acquire);
+        for (int s = 0; s < kNumProfileStages; ++s) {
+            snap.totalTicks[s] = totalTicks[s].load(std::memory_order_relaxed);
+            snap.maxTicks[s] = maxTicks[s].load(std::memory_order_relaxed);
+            for (int b = 0; b < kBuckets; ++b)
+                snap.histogram[s][b] = histogram[s][b].load(std::memory_order_relaxed);
+        }
+        return snap;
+    }
+
+    void dump(FILE* f) const {
+        const Snapshot snap = snapshot();
+        std::fprintf(f, "5yn7h_ stage profile: %llu blocks (ticks per block)\n",
+                     (unsigned long long)snap.blocks);
+        for (int s = 0; s < kNumProfileStages; ++s) {
+            const double mean = snap.blocks ? double(snap.totalTicks[s]) / double(snap.blocks) : 0.0;
+            std::fprintf(f, "  %-7s mean %10.0f  max %10llu  |", kProfileStageNames[s], mean,
+                         (unsigned long long)snap.maxTicks[s]);
+            for (int b = 0; b < kBuckets; ++b)
+                if (snap.histogram[s][b])
+                    std::fprintf(f, " 2^%d:%llu", b, (unsigned long long)snap.histogram[s][b]);
+            std::fprintf(f, "\n");
+        }
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& a, uint64_t v) {
+        a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+    uint64_t pending[kNumProfileStages] = {};
+    std::atomic<uint64_t> blocks{0};
+    std::atomic<uint64_t> totalTicks[kNumProfileStages] = {};
+    std::atomic<uint64_t> maxTicks[kNumProfileStages] = {};
+    std::atomic<uint64_t> histogram[kNumProfileStages][kBuckets] = {};
+};
+
+#ifdef SYNTH_PROFILE
+#define SYNTH_PROFILE_SCOPE(profiler, stage) StageProfiler::Scope profileScope_(profiler, stage)
+#define SYNTH_PROFILE_END_BLOCK(profiler) (profiler).endBlock()
+#else
+#define SYNTH_PROFILE_SCOPE(profiler, stage) ((void)0)
+#define SYNTH_PROFILE_END_BLOCK(profiler) ((void)0)
+#endif
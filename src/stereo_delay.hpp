@@ -0,0 +1,108 @@
+// stereo_delay.hpp - Multi-tap ping-pong delay
+// Both channels share one interleaved ring whose size is a power of two, so a
+// tap read fetches L and R from the same cache line and wrapping is a mask.
+// Each sample reads every tap in one pass. Read positions are fractional and
+// follow the Time control through a one-pole glide, so turning it bends the
+// pitch of the repeats instead of clicking. Taps are spread evenly up to the
+// full delay time; the last tap feeds back, optionally crossing channels.
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "delay_storage.hpp"
+
+class StereoDelay {
+public:
+    static constexpr int kMaxTaps = 4;
+    static constexpr float kMaxTimeMs = 2000.0f;
+
+    // Allocates the ring for this rate; called from activate(), never from
+    // the audio thread
+    void prepare(float sampleRate) {
+        rate = sampleRate;
+        const uint32_t needed = uint32_t(std::ceil(kMaxTimeMs * 0.001f * sampleRate)) + 2;
+        uint32_t frames = 1;
+        while (frames < needed) frames <<= 1;
+        mask = frames - 1;
+        buf.assign(size_t(frames) * 2, DelayStorage::Sample{});
+        glideCoef = 1.0f - std::exp(-1.0f / (0.05f * sampleRate)); // 50 ms
+        setTime(timeMs);
+        reset();
+    }
+
+    void reset() {
+        std::fill(buf.begin(), buf.end(), DelayStorage::Sample{});
+        writePos = 0;
+        lpL = lpR = 0.0f;
+        primed = false;
+    }
+
+    void setTime(float ms) {
+        timeMs = std::clamp(ms, 1.0f, kMaxTimeMs);
+        target = std::max(timeMs * 0.001f * rate, 1.0f);
+    }
+    void setFeedback(float f) { feedback = std::clamp(f, 0.0f, 0.95f); }
+    // 0 keeps the channels apart; 1 feeds the input's mid to the left line and
+    // bounces every repeat to the other side
+    void setPingPong(float p) { pingPong = std::clamp(p, 0.0f, 1.0f); }
+    void setTaps(int count) {
+        taps = std::clamp(count, 1, kMaxTaps);
+        // Later taps louder; gains sum to one so the tap count doesn't change level
+        const float norm = 2.0f / float(taps * (taps + 1));
+        for (int k = 0; k < taps; ++k) {
+            tapPos[k] = float(k + 1) / float(taps);
+            tapGain[k] = float(k + 1) * norm;
+        }
+    }
+
+    void process(float* left, float* right, uint32_t n, float mix) {
+        const float dry = 1.0f - mix;
+        const float straight = 1.0f - pingPong, cross = pingPong;
+        // An empty line has nothing to glide from
+        if (!primed) { delay = target; primed = true; }
+        for (uint32_t i = 0; i < n; ++i) {
+            delay += (target - delay) * glideCoef;
+            float wetL = 0.0f, wetR = 0.0f, lastL = 0.0f, lastR = 0.0f;
+            for (int k = 0; k < taps; ++k) {
+                const float d = std::max(delay * tapPos[k], 1.0f);
+                const uint32_t whole = uint32_t(d);
+                const float frac = d - float(whole);
+                const uint32_t a = ((writePos - whole) & mask) * 2;
+                const uint32_t b = ((writePos - whole - 1) & mask) * 2;
+                const float aL = DelayStorage::decode(buf[a]), aR = DelayStorage::decode(buf[a + 1]);
+                lastL = aL + (DelayStorage::decode(buf[b]) - aL) * frac;
+                lastR = aR + (DelayStorage::decode(buf[b + 1]) - aR) * frac;
+                wetL += tapGain[k] * lastL;
+                wetR += tapGain[k] * lastR;
+            }
+            // Lowpass in the feedback path darkens each repeat
+            lpL = 0.7f * lpL + 0.3f * lastL;
+            lpR = 0.7f * lpR + 0.3f * lastR;
+            const float inL = left[i], inR = right[i];
+            const float mid = 0.5f * (inL + inR);
+            const uint32_t w = writePos * 2;
+            buf[w] = codec.encode(straight * inL + cross * mid + feedback * (straight * lpL + cross * lpR));
+            buf[w + 1] = codec.encode(straight * inR + feedback * (straight * lpR + cross * lpL));
+            writePos = (writePos + 1) & mask;
+            left[i] = inL * dry + wetL * mix;
+            right[i] = inR * dry + wetR * mix;
+        }
+    }
+
+    // Interleaved L/R frames in the build's DelayStorage format
+    std::vector<DelayStorage::Sample> buf;
+
+private:
+    DelayStorage codec;
+    float rate = 48000.0f;
+    uint32_t mask = 0;
+    uint32_t writePos = 0;
+    float timeMs = 375.0f;
+    float target = 1.0f, delay = 1.0f, glideCoef = 1.0f;
+    float feedback = 0.45f, pingPong = 0.0f;
+    float lpL = 0.0f, lpR = 0.0f;
+    int taps = 1;
+    bool primed = false;
+    float tapPos[kMaxTaps] = {1.0f}, tapGain[kMaxTaps] = {1.0f};
+};
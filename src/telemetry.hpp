@@ -0,0 +1,22 @@
+// telemetry.hpp - Wait-free metering channel out of the audio thread
+// run() pushes one small record per block into a single-producer,
+// single-consumer ring; one reader (UI, offline renderer, debug dump) drains
+// it from any other thread. Neither side ever blocks or allocates: a full ring
+// drops the new record and counts it.
+#pragma once
+#include <cstdint>
+#include "spsc_ring.hpp"
+
+// One run() block
+struct TelemetryBlock {
+    uint64_t frame;         // position of the block's first sample since activate()
+    uint32_t frames;
+    int32_t engine;         // registry index of the live engine
+    float peakL, peakR;     // sample peak of the output
+    float rmsL, rmsR;
+    float envelope;         // ADSR level at the end of the block
+    float load;             // block time / deadline (see DeadlineMonitor)
+};
+
+// About 2.7 s of 512-frame blocks at 48 kHz before a stalled reader drops data
+using TelemetryRing = SpscRing<TelemetryBlock, 256>;
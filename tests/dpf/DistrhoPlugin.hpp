@@ -0,0 +1,86 @@
+// DistrhoPlugin.hpp - Headless stand-in for DPF's plugin base, tests only
+// Declares just the parts of the DPF API the plugin uses, so the tests build
+// without a DPF checkout. The test plays the host: it sets `hostSampleRate`,
+// then calls sampleRateChanged(), activate() and run() like a host would.
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include "DistrhoPluginInfo.h"
+
+#define START_NAMESPACE_DISTRHO namespace DISTRHO {
+#define END_NAMESPACE_DISTRHO }
+#define USE_NAMESPACE_DISTRHO using namespace DISTRHO;
+#define d_cconst(a, b, c, d) (((a) << 24) | ((b) << 16) | ((c) << 8) | (d))
+#define d_version(major, minor, micro) (((major) << 16) | ((minor) << 8) | (micro))
+
+namespace DISTRHO {
+
+struct String {
+    const char* text = "";
+    String& operator=(const char* s) { text = s; return *this; }
+    operator const char*() const { return text; }
+};
+
+enum { kParameterIsAutomatable = 1, kParameterIsBoolean = 2, kParameterIsInteger = 4,
+       kParameterIsLogarithmic = 8, kParameterIsOutput = 16 };
+enum { kStateIsFilenamePath = 1 };
+
+struct ParameterRanges { float def = 0.0f, min = 0.0f, max = 1.0f; };
+struct Parameter { uint32_t hints = 0; String name, symbol, unit; ParameterRanges ranges; };
+struct State { uint32_t hints = 0; String key, defaultValue, label, description; };
+
+struct MidiEvent {
+    uint32_t frame;
+    uint32_t size;
+    uint8_t data[4];
+    const uint8_t* dataExt;
+};
+
+struct TimePosition {
+    bool playing = false;
+    uint64_t frame = 0;
+    struct BarBeatTick {
+        bool valid = false;
+        int32_t bar = 1, beat = 1;
+        double tick = 0.0, barStartTick = 0.0;
+        float beatsPerBar = 4.0f, beatType = 4.0f;
+        double ticksPerBeat = 1920.0, beatsPerMinute = 120.0;
+    } bbt;
+};
+
+class Plugin {
+public:
+    Plugin(uint32_t, uint32_t, uint32_t) {}
+    virtual ~Plugin() {}
+
+    double getSampleRate() const { return hostSampleRate; }
+    const TimePosition& getTimePosition() const { return timePosition; }
+    void setLatency(uint32_t frames) { hostLatency = frames; }
+
+    virtual const char* getLabel() const = 0;
+    virtual const char* getMaker() const = 0;
+    virtual const char* getLicense() const = 0;
+    virtual uint32_t getVersion() const = 0;
+    virtual int64_t getUniqueId() const = 0;
+    virtual void initParameter(uint32_t, Parameter&) = 0;
+    virtual void initState(uint32_t, State&) {}
+    virtual void setState(const char*, const char*) {}
+    virtual float getParameterValue(uint32_t) const = 0;
+    virtual void setParameterValue(uint32_t, float) = 0;
+    virtual void activate() {}
+    virtual void deactivate() {}
+    virtual void sampleRateChanged(double) {}
+    virtual void run(const float**, float**, uint32_t, const MidiEvent*, uint32_t) = 0;
+
+    // Host side
+    double hostSampleRate = 48000.0;
+    TimePosition timePosition;
+    uint32_t hostLatency = 0;
+};
+
+Plugin* createPlugin();
+
+} // namespace DISTRHO
+
+static inline void d_stdout(const char*, ...) {}
+static inline void d_stderr(const char*, ...) {}
@@ -0,0 +1,51 @@
+// headless.hpp - The plugin driven without a host, for the tests
+// Builds the plugin translation unit against the DPF stand-in in dpf/ and
+// plays the host's part: rate, activation, MIDI and run().
+#pragma once
+#include "DistrhoPlugin5yn7h_.cpp"
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+USE_NAMESPACE_DISTRHO
+
+// The plugin as a host sets it up for `rate`, not yet activated
+inline std::unique_ptr<Plugin5yn7h_> makePlugin(double rate) {
+    std::unique_ptr<Plugin5yn7h_> plugin(new Plugin5yn7h_());
+    plugin->hostSampleRate = rate;
+    plugin->sampleRateChanged(rate);
+    return plugin;
+}
+
+inline MidiEvent noteOn(uint8_t note, uint32_t frame = 0) { return MidiEvent{ frame, 3, { 0x90, note, 100, 0 }, nullptr }; }
+inline MidiEvent noteOff(uint8_t note, uint32_t frame = 0) { return MidiEvent{ frame, 3, { 0x80, note, 0, 0 }, nullptr }; }
+
+// Renders `frames` in host blocks of `block`, with a note-on at frame 0 held
+// throughout; returns the left channel
+inline std::vector<float> renderNote(Plugin5yn7h_& plugin, uint8_t note, size_t frames, uint32_t block = 256) {
+    std::vector<float> left(frames + block), right(frames + block);
+    const MidiEvent on = noteOn(note);
+    for (size_t pos = 0; pos < frames; pos += block) {
+        float* outputs[2] = { left.data() + pos, right.data() + pos };
+        plugin.run(nullptr, outputs, block, &on, pos == 0 ? 1 : 0);
+    }
+    left.resize(frames);
+    return left;
+}
+
+// Failed checks are printed and counted; main() returns the count
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void check(bool ok, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    std::printf(ok ? "ok    " : "FAIL  ");
+    std::vprintf(format, args);
+    std::printf("\n");
+    va_end(args);
+    if (!ok) ++failures();
+}
@@ -0,0 +1,149 @@
+// test_convolution.cpp - Convolution reverb output, IR swaps and footprint
+// The reverb's impulse response matches the IR it was given (normalized,
+// kHeadBlock samples late) across the head and the worker's tail. A second IR
+// loaded while it runs is taken at the next block, without the loader waiting
+// for the audio thread. Without an IR an activated instance holds no
+// convolution buffers and no worker thread.
+#include "headless.hpp"
+#include <chrono>
+#include <cmath>
+#include <dirent.h>
+#include <random>
+#include <thread>
+#include <unistd.h>
+
+static constexpr float kRate = 48000.0f;
+static constexpr uint32_t kBlock = 256;
+
+// Stereo 32-bit float WAV of decaying noise, `seconds` long
+static std::string writeImpulse(const char* name, float seconds, uint32_t seed) {
+    const std::string path = "/tmp/" + std::to_string(getpid()) + "_" + name + ".wav";
+    const uint32_t frames = uint32_t(seconds * kRate);
+    std::vector<float> data(size_t(frames) * 2);
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    for (uint32_t i = 0; i < frames; ++i) {
+        const float decay = std::exp(-4.0f * float(i) / float(frames));
+        data[2 * i] = noise(random) * decay;
+        data[2 * i + 1] = noise(random) * decay;
+    }
+    auto u32 = [](std::FILE* f, uint32_t v) { std::fwrite(&v, 4, 1, f); };
+    auto u16 = [](std::FILE* f, uint16_t v) { std::fwrite(&v, 2, 1, f); };
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    const uint32_t bytes = uint32_t(data.size() * 4);
+    std::fwrite("RIFF", 1, 4, f); u32(f, 36 + bytes); std::fwrite("WAVE", 1, 4, f);
+    std::fwrite("fmt ", 1, 4, f); u32(f, 16); u16(f, 3); u16(f, 2); u32(f, uint32_t(kRate));
+    u32(f, uint32_t(kRate) * 8); u16(f, 8); u16(f, 32);
+    std::fwrite("data", 1, 4, f); u32(f, bytes);
+    std::fwrite(data.data(), 4, data.size(), f);
+    std::fclose(f);
+    return path;
+}
+
+// The IR as the reverb plays it: at kRate, normalized to unit energy in the louder channel
+static void expected(const char* path, std::vector<float>& left, std::vector<float>& right) {
+    ImpulseResponse ir;
+    ir.load(path);
+    double energyL = 0.0, energyR = 0.0;
+    for (size_t i = 0; i < ir.left.size(); ++i) {
+        energyL += double(ir.left[i]) * ir.left[i];
+        energyR += double(ir.right[i]) * ir.right[i];
+    }
+    const float gain = float(1.0 / std::sqrt(std::max(energyL, energyR)));
+    left.resize(ir.left.size());
+    right.resize(ir.right.size());
+    for (size_t i = 0; i < ir.left.size(); ++i) {
+        left[i] = ir.left[i] * gain;
+        right[i] = ir.right[i] * gain;
+    }
+}
+
+// Fully wet response to a unit impulse at frame 0, `frames` long. After each
+// tail block the worker gets a moment, so no block is late.
+static void impulseResponse(ConvolutionReverb& reverb, size_t frames, std::vector<float>& left, std::vector<float>& right) {
+    left.assign(frames, 0.0f);
+    right.assign(frames, 0.0f);
+    left[0] = right[0] = 1.0f;
+    for (size_t pos = 0; pos < frames; pos += kBlock) {
+        if (!reverb.impulseReady()) return;
+        reverb.process(left.data() + pos, right.data() + pos, kBlock, 1.0f);
+        if ((pos + kBlock) % Convolver::kTailBlock == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+// Largest difference from the IR at `path`, delayed by kHeadBlock
+static float responseError(ConvolutionReverb& reverb, const char* path) {
+    std::vector<float> wantL, wantR, gotL, gotR;
+    expected(path, wantL, wantR);
+    impulseResponse(reverb, (wantL.size() + Convolver::kHeadBlock + kBlock) / kBlock * kBlock, gotL, gotR);
+    float worst = 0.0f;
+    for (size_t i = 0; i < gotL.size(); ++i) {
+        const size_t k = i - Convolver::kHeadBlock;
+        const bool inside = i >= Convolver::kHeadBlock && k < wantL.size();
+        worst = std::max(worst, std::fabs(gotL[i] - (inside ? wantL[k] : 0.0f)));
+        worst = std::max(worst, std::fabs(gotR[i] - (inside ? wantR[k] : 0.0f)));
+    }
+    return worst;
+}
+
+static int threads() {
+    int count = 0;
+    if (DIR* dir = opendir("/proc/self/task")) {
+        while (dirent* entry = readdir(dir)) count += entry->d_name[0] != '.';
+        closedir(dir);
+    }
+    return count;
+}
+
+static long residentBytes() {
+    long pages = 0, resident = 0;
+    std::FILE* f = std::fopen("/proc/self/statm", "r");
+    if (f && std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    if (f) std::fclose(f);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+static void testResponse(const std::string& first, const std::string& second) {
+    ConvolutionReverb reverb;
+    reverb.loadFile(first.c_str());
+    reverb.prepare(kRate);
+    const float longError = responseError(reverb, first.c_str());
+    check(longError <= 1e-4f, "1.5 s IR: max difference %g from the normalized IR", double(longError));
+    // No audio block runs between these loads, so the first is still waiting
+    // to be picked up when the second replaces it: neither may wait for one
+    const auto start = std::chrono::steady_clock::now();
+    const bool loaded = reverb.loadFile(first.c_str()) && reverb.loadFile(second.c_str());
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    check(loaded && ms < 100.0, "two loads while active, no audio block between them: %.1f ms", ms);
+    const float shortError = responseError(reverb, second.c_str());
+    check(shortError <= 1e-4f, "0.05 s IR, swapped in at the next block: max difference %g", double(shortError));
+    reverb.stop();
+}
+
+static void testFootprint(const std::string& path) {
+    constexpr int kInstances = 20;
+    const int baseThreads = threads();
+    std::vector<std::unique_ptr<Plugin5yn7h_>> plugins;
+    const long before = residentBytes();
+    for (int i = 0; i < kInstances; ++i) {
+        plugins.push_back(makePlugin(kRate));
+        plugins.back()->activate();
+    }
+    const double perInstance = double(residentBytes() - before) / kInstances / 1048576.0;
+    check(perInstance <= 1.5, "no IR: %.2f MB resident per activated instance at 48 kHz", perInstance);
+    check(threads() == baseThreads, "no IR: no worker threads (%d extra)", threads() - baseThreads);
+    plugins[0]->setState("ir_file", path.c_str());
+    check(threads() == baseThreads + 1, "an IR with a tail loaded into one instance: one worker");
+    plugins[0]->deactivate();
+    check(threads() == baseThreads, "deactivated: the worker is gone");
+}
+
+int main() {
+    const std::string longIr = writeImpulse("long", 1.5f, 1), shortIr = writeImpulse("short", 0.05f, 2);
+    testResponse(longIr, shortIr);
+    testFootprint(longIr);
+    std::remove(longIr.c_str());
+    std::remove(shortIr.c_str());
+    std::printf("%d failed\n", failures());
+    return failures() == 0 ? 0 : 1;
+}
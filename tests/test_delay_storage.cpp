@@ -0,0 +1,88 @@
+// test_delay_storage.cpp - Noise floors and cost of the delay-line formats
+// Every format is built here whatever DELAY_STORAGE the plugin uses. One pass
+// through a line is one encode() and decode(); the error against the input is
+// held to the floors README documents: for int16 a constant dither floor, for
+// fp16 an error that falls away with the signal. Each repeat of the delay is
+// another pass. The streaming cost of each format over 64 lines, the case the
+// 16-bit formats were meant to speed up, is reported but not asserted:
+// timings depend on the machine.
+#include "headless.hpp"
+#include <chrono>
+#include <cmath>
+
+static constexpr double kRate = 48000.0;
+static constexpr double kInt16Floor = -84.0; // dBFS RMS, README "Delay Storage"
+static constexpr double kHalfFloor = -96.0;  // dBFS RMS for a -20 dBFS tone
+
+static double dbfs(double rms) { return 20.0 * std::log10(rms); }
+
+// RMS error of one pass of a 440 Hz tone at `level` (peak, linear) for 1 s
+template <typename Storage>
+static double passError(float level) {
+    Storage codec;
+    double sum = 0.0;
+    const int frames = int(kRate);
+    for (int i = 0; i < frames; ++i) {
+        const float x = level * float(std::sin(2.0 * M_PI * 440.0 * double(i) / kRate));
+        const double e = double(Storage::decode(codec.encode(x))) - double(x);
+        sum += e * e;
+    }
+    return std::sqrt(sum / frames);
+}
+
+static void testNoise() {
+    const double tone = dbfs(passError<Int16Storage>(0.1f)), silence = dbfs(passError<Int16Storage>(0.0f));
+    check(tone <= kInt16Floor && silence <= kInt16Floor, "int16: %.1f dBFS with a -20 dBFS tone, %.1f in silence (floor %.0f)",
+          tone, silence, kInt16Floor);
+    check(silence >= kInt16Floor - 3.0, "int16: the dither floor stays up in silence (%.1f dBFS)", silence);
+    const double half = dbfs(passError<HalfStorage>(0.1f)), quiet = dbfs(passError<HalfStorage>(0.001f));
+    check(half <= kHalfFloor, "fp16: %.1f dBFS with a -20 dBFS tone (floor %.0f)", half, kHalfFloor);
+    check(quiet <= half - 30.0, "fp16: %.1f dBFS with a -60 dBFS tone, falling with the signal", quiet);
+    check(passError<FloatStorage>(0.1f) == 0.0, "float: lossless");
+}
+
+// ns per sample to write and read back kLines lines of 1 s each, best of 5
+template <typename Storage>
+static double streamCost() {
+    constexpr int kLines = 64, kFrames = int(kRate);
+    std::vector<typename Storage::Sample> lines(size_t(kLines) * kFrames);
+    Storage codecs[kLines];
+    float in[64], out[64] = {};
+    for (int i = 0; i < 64; ++i) in[i] = 0.1f * float(std::sin(0.06 * i));
+    double best = 1e9;
+    for (int round = 0; round < 5; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int pos = 0; pos < kFrames; pos += 64) {
+            const int n = std::min(64, kFrames - pos);
+            for (int l = 0; l < kLines; ++l) {
+                typename Storage::Sample* line = lines.data() + size_t(l) * kFrames;
+                // Read what was written a line length (one round) ago
+                for (int i = 0; i < n; ++i) {
+                    const float y = Storage::decode(line[pos + i]);
+                    out[i] += y;
+                    line[pos + i] = codecs[l].encode(in[i] + 0.5f * y);
+                }
+            }
+        }
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, ns / (double(kLines) * kFrames));
+    }
+    volatile float sink = out[0];
+    (void)sink;
+    return best;
+}
+
+static void reportCost() {
+    std::printf("info  ns/sample over 64 one-second lines: float %.2f (%zu B), fp16 %.2f (%zu B), int16 %.2f (%zu B)\n",
+                streamCost<FloatStorage>(), sizeof(FloatStorage::Sample), streamCost<HalfStorage>(),
+                sizeof(HalfStorage::Sample), streamCost<Int16Storage>(), sizeof(Int16Storage::Sample));
+    check(sizeof(HalfStorage::Sample) * 2 == sizeof(float) && sizeof(Int16Storage::Sample) * 2 == sizeof(float),
+          "16-bit formats halve the line memory");
+}
+
+int main() {
+    testNoise();
+    reportCost();
+    std::printf("%d failed\n", failures());
+    return failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+// test_eco.cpp - Eco mode latency and host block size invariance
+// At 96 and 192 kHz Eco renders the chain at 48 kHz and upsamples it. The
+// latency reported to the host must grow by exactly the upsampler's delay,
+// and that delay must be where the upsampler really puts an impulse. The
+// output must not depend on how the host slices the stream: blocks of 37, 77
+// and 256 frames must give what 1-frame blocks give, with the default LFO
+// tremolo running, for a few engines.
+#include "headless.hpp"
+#include <cmath>
+
+static const double kRates[] = { 96000.0, 192000.0 };
+static const uint32_t kBlocks[] = { 1, 37, 77, 256 };
+static const int kEngines[] = { 0, 3, 13, 15 }; // Sine, Saw, Wavefolder, String Bank
+static constexpr float kTolerance = 1e-6f;
+
+static std::unique_ptr<Plugin5yn7h_> makeEco(double rate, bool eco, int engine = 0) {
+    std::unique_ptr<Plugin5yn7h_> plugin = makePlugin(rate);
+    plugin->setParameterValue(kParamModel, float(engine));
+    plugin->setParameterValue(kParamEco, eco ? 1.0f : 0.0f);
+    plugin->activate();
+    return plugin;
+}
+
+// Where the upsampler puts a unit impulse, in host-rate samples
+static uint32_t impulseDelay(int factor) {
+    PolyphaseUpsampler up;
+    up.prepare(factor);
+    float in[PolyphaseUpsampler::kMaxBlock] = { 1.0f }, out[PolyphaseUpsampler::kMaxBlock * PolyphaseUpsampler::kMaxFactor];
+    up.process(in, PolyphaseUpsampler::kMaxBlock, out);
+    uint32_t peak = 0;
+    for (uint32_t i = 0; i < PolyphaseUpsampler::kMaxBlock * uint32_t(factor); ++i)
+        if (std::fabs(out[i]) > std::fabs(out[peak])) peak = i;
+    return peak;
+}
+
+static void testLatency(double rate) {
+    const int factor = int(rate / 48000.0);
+    const uint32_t plain = makeEco(rate, false)->hostLatency, eco = makeEco(rate, true)->hostLatency;
+    PolyphaseUpsampler up;
+    up.prepare(factor);
+    check(eco - plain == up.getLatency() && up.getLatency() == impulseDelay(factor),
+          "%.0f kHz: Eco adds %u frames of latency, the upsampler delays an impulse by %u", rate / 1000.0,
+          eco - plain, impulseDelay(factor));
+}
+
+static void testBlockSizes(double rate, int engine) {
+    const size_t frames = size_t(0.5 * rate);
+    std::vector<float> reference;
+    for (uint32_t block : kBlocks) {
+        std::unique_ptr<Plugin5yn7h_> plugin = makeEco(rate, true, engine);
+        const std::vector<float> out = renderNote(*plugin, 57, frames, block);
+        if (reference.empty()) {
+            reference = out;
+            continue;
+        }
+        float worst = 0.0f, peak = 0.0f;
+        for (size_t i = 0; i < frames; ++i) {
+            worst = std::max(worst, std::fabs(out[i] - reference[i]));
+            peak = std::max(peak, std::fabs(reference[i]));
+        }
+        check(peak > 0.01f && worst <= kTolerance, "%.0f kHz, %-11s %3u-frame blocks against 1: max difference %g",
+              rate / 1000.0, SynthEngines::name(engine), block, double(worst));
+    }
+}
+
+int main() {
+    for (double rate : kRates) {
+        testLatency(rate);
+        for (int engine : kEngines) testBlockSizes(rate, engine);
+    }
+    std::printf("%d failed\n", failures());
+    return failures() == 0 ? 0 : 1;
+}
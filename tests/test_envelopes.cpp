@@ -0,0 +1,63 @@
+// test_envelopes.cpp - The block envelope renderers match per-sample process()
+// PeaksADSR (in both modes) and PeaksAD render closed-form ramps a segment at
+// a time in processBlock(). Two copies get the same random script at every
+// block boundary (gate on/off, new times and sustain mid-segment) and odd
+// block sizes; the one rendered with processBlock(n) must match the one
+// stepped with n process() calls to within kTolerance at every sample.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "headless.hpp"
+
+static constexpr float kTolerance = 1e-6f; // the segments are closed-form: exact in practice
+static constexpr int kBlocks = 20000;
+
+// Renders the script into both copies; `change` applies one random event
+template <typename Envelope, typename Change>
+static void compare(const char* name, Envelope block, Envelope single, Change change) {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> size(1, 64), event(0, 7);
+    float out[64];
+    float worst = 0.0f;
+    long samples = 0, gates = 0;
+    for (int b = 0; b < kBlocks; ++b) {
+        // Most blocks change nothing, so segments also end inside blocks
+        const int e = event(random);
+        if (e == 0) { block.gateOn(); single.gateOn(); ++gates; }
+        else if (e == 1) { block.gateOff(); single.gateOff(); ++gates; }
+        else if (e == 2) change(random, block, single);
+        const uint32_t n = uint32_t(size(random));
+        block.processBlock(out, n);
+        for (uint32_t i = 0; i < n; ++i) worst = std::max(worst, std::fabs(out[i] - single.process()));
+        samples += n;
+    }
+    check(worst <= kTolerance, "%-10s max difference %g over %ld samples, %ld gate events", name, double(worst),
+          samples, gates);
+}
+
+// Times short enough that most segments end within a few blocks
+static float time(std::mt19937& random) { return std::uniform_real_distribution<float>(0.0005f, 0.05f)(random); }
+
+int main() {
+    const auto adsrChange = [](std::mt19937& random, PeaksADSR& a, PeaksADSR& b) {
+        switch (random() % 5) {
+        case 0: { const float t = time(random); a.setAttack(t); b.setAttack(t); break; }
+        case 1: { const float t = time(random); a.setDecay(t); b.setDecay(t); break; }
+        case 2: { const float s = std::uniform_real_distribution<float>(0.0f, 1.0f)(random); a.setSustain(s); b.setSustain(s); break; }
+        case 3: { const float t = time(random); a.setRelease(t); b.setRelease(t); break; }
+        default: { const float sr = random() % 2 ? 48000.0f : 44100.0f; a.setSampleRate(sr); b.setSampleRate(sr); break; }
+        }
+    };
+    PeaksADSR adsr;
+    compare("ADSR", adsr, adsr, adsrChange);
+    adsr.setMode(PeaksADSR::AD);
+    compare("ADSR (AD)", adsr, adsr, adsrChange);
+    compare("AD", PeaksAD(), PeaksAD(), [](std::mt19937& random, PeaksAD& a, PeaksAD& b) {
+        const float t = time(random);
+        if (random() % 2) { a.setAttack(t); b.setAttack(t); }
+        else { a.setDecay(t); b.setDecay(t); }
+    });
+    std::printf("%d failed\n", failures());
+    return failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+// test_instance_budget.cpp - The constructor stays cheap enough for host scans
+// Hosts construct the plugin to scan it and for every instance of a project
+// before activating any. The constructor defers buffers and engines to
+// activate(), so constructing many instances must stay within a few
+// tens of microseconds each.
+#include "headless.hpp"
+#include <algorithm>
+#include <chrono>
+
+static constexpr int kInstances = 500;
+static constexpr double kBudgetMicros = 50.0; // per instance; typically 15 or so
+
+int main() {
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::unique_ptr<Plugin5yn7h_>> plugins;
+    plugins.reserve(kInstances);
+    // Best of a few rounds, so a busy machine doesn't fail the test
+    double best = 1e9;
+    for (int round = 0; round < 3; ++round) {
+        plugins.clear();
+        const Clock::time_point start = Clock::now();
+        for (int i = 0; i < kInstances; ++i) plugins.emplace_back(new Plugin5yn7h_());
+        const double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        best = std::min(best, micros / kInstances);
+    }
+    check(best <= kBudgetMicros, "constructor: %.2f us per instance over %d instances (budget %.0f us)",
+          best, kInstances, kBudgetMicros);
+    std::printf("%d failed\n", failures());
+    return failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+// test_lfo_sync.cpp - Tempo-synced LFOs stay in phase across instances
+// Two instances play the same note from the same song position, one in
+// 128-frame host blocks and one in 512-frame blocks, with the LFO synced to
+// 1/4 notes and routed to Level (the default tremolo route). Before the note,
+// one sat on a stopped transport at another tempo, so its free-running LFO
+// has drifted; once the transport rolls, both must take the same phase from
+// the song position and so produce the same output. A host that reports BBT
+// as valid with a zero tick resolution or meter must not turn the LFO into NaN.
+#include "headless.hpp"
+#include <cmath>
+
+static constexpr double kRate = 48000.0;
+static constexpr double kTempo = 120.0;
+static constexpr uint64_t kNoteFrame = 122 * 512; // ~1.3 s: not a whole number of LFO cycles
+static constexpr float kTolerance = 1e-4f;
+
+// The position a 4/4 host reports for `frame` at `tempo`
+static void place(Plugin5yn7h_& plugin, uint64_t frame, double tempo, bool playing) {
+    TimePosition& pos = plugin.timePosition;
+    const double beats = double(frame) / kRate * tempo / 60.0;
+    pos.playing = playing;
+    pos.frame = frame;
+    pos.bbt.valid = true;
+    pos.bbt.bar = int32_t(beats / 4.0) + 1;
+    pos.bbt.beat = int32_t(std::fmod(beats, 4.0)) + 1;
+    pos.bbt.tick = (beats - std::floor(beats)) * pos.bbt.ticksPerBeat;
+    pos.bbt.beatsPerMinute = tempo;
+}
+
+// LFO Sync `division`: an index into kLfoDivisions
+static std::unique_ptr<Plugin5yn7h_> makeSynced(int division) {
+    std::unique_ptr<Plugin5yn7h_> plugin = makePlugin(kRate);
+    plugin->setParameterValue(kParamLfoSync, float(division));
+    plugin->setParameterValue(kParamMod1Amount, 0.5f);
+    plugin->activate();
+    return plugin;
+}
+
+// Left output from frame 0 to `end` in host blocks of `block`. Before the
+// note the transport is stopped at `stoppedTempo`, or rolling if that is 0.
+static std::vector<float> play(uint32_t block, double stoppedTempo, uint64_t end) {
+    std::unique_ptr<Plugin5yn7h_> plugin = makeSynced(5); // 1/4
+    std::vector<float> left(end), right(end);
+    const MidiEvent on = noteOn(69);
+    for (uint64_t frame = 0; frame < end; frame += block) {
+        const bool rolling = frame >= kNoteFrame || stoppedTempo == 0.0;
+        place(*plugin, rolling ? frame : 0, rolling ? kTempo : stoppedTempo, rolling);
+        float* outputs[2] = { left.data() + frame, right.data() + frame };
+        plugin->run(nullptr, outputs, block, &on, frame == kNoteFrame ? 1 : 0);
+    }
+    return left;
+}
+
+static void testCoherence() {
+    const uint64_t end = kNoteFrame + 141 * 512; // ~1.5 s, whole blocks for both
+    const std::vector<float> a = play(128, 0.0, end);
+    const std::vector<float> b = play(512, 93.0, end);
+    // From once the level ramps of both have settled into the tremolo
+    float worst = 0.0f, peak = 0.0f;
+    for (uint64_t i = kNoteFrame + uint64_t(0.25 * kRate); i < end; ++i) {
+        worst = std::max(worst, std::fabs(a[i] - b[i]));
+        peak = std::max(peak, std::fabs(a[i]));
+    }
+    check(peak > 0.1f && worst <= kTolerance, "128 vs 512 frame blocks: max difference %g (output peak %g)",
+          double(worst), double(peak));
+}
+
+static void testZeroResolution() {
+    for (int field = 0; field < 2; ++field) {
+        // The meter only enters bar divisions
+        std::unique_ptr<Plugin5yn7h_> plugin = makeSynced(field == 0 ? 5 : 3); // 1/4, 1 bar
+        std::vector<float> left(256), right(256);
+        float* outputs[2] = { left.data(), right.data() };
+        const MidiEvent on = noteOn(69);
+        bool finite = true;
+        for (int b = 0; b < 200; ++b) {
+            place(*plugin, uint64_t(b) * 256, kTempo, true);
+            if (field == 0) plugin->timePosition.bbt.ticksPerBeat = 0.0;
+            else plugin->timePosition.bbt.beatsPerBar = 0.0f;
+            plugin->run(nullptr, outputs, 256, &on, b == 0 ? 1 : 0);
+            for (float x : left) finite = finite && std::isfinite(x);
+        }
+        check(finite, "%s of 0: output stays finite", field == 0 ? "ticksPerBeat" : "beatsPerBar");
+    }
+}
+
+int main() {
+    testCoherence();
+    testZeroResolution();
+    std::printf("%d failed\n", failures());
+    return failures() == 0 ? 0 : 1;
+}
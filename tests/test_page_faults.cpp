@@ -0,0 +1,81 @@
+// test_page_faults.cpp - The first blocks after activate() take no page faults
+// activate() prefaults every buffer run() touches, so a fresh instance's first
+// note must not fault on the audio thread. Counts the minor faults of this
+// thread while each engine plays its first blocks, with the delay, chorus and
+// reverb wet, for long enough that the telemetry ring wraps once.
+// A warm-up instance plays first and stays alive, so code and stack pages are
+// mapped, as in a host running other instances. The measured instance is
+// built on freshly mapped pages (transparent huge pages off), so it can't
+// inherit pages that another instance or allocation already faulted in.
+#include "headless.hpp"
+#include <new>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+
+static const double kRates[] = { 48000.0, 192000.0 };
+static constexpr uint32_t kBlock = 256;
+static constexpr int kBlocks = 320; // past one wrap of the 256-slot telemetry ring
+
+static long minorFaults() {
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_minflt;
+}
+
+// Unmaps what freshInstance() mapped
+struct FreshPages {
+    void operator()(Plugin5yn7h_* plugin) const {
+        plugin->~Plugin5yn7h_();
+        munmap(plugin, sizeof(Plugin5yn7h_));
+    }
+};
+using FreshPlugin = std::unique_ptr<Plugin5yn7h_, FreshPages>;
+
+static FreshPlugin freshInstance() {
+    void* pages = mmap(nullptr, sizeof(Plugin5yn7h_), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED) { std::perror("mmap"); std::exit(1); }
+    return FreshPlugin(new (pages) Plugin5yn7h_());
+}
+
+// As a host sets up `plugin` for `rate`, then activated
+template <typename Pointer>
+static Pointer activated(Pointer plugin, double rate, int engine) {
+    plugin->hostSampleRate = rate;
+    plugin->sampleRateChanged(rate);
+    plugin->setParameterValue(kParamModel, float(engine));
+    plugin->setParameterValue(kParamDelay, 0.5f);
+    plugin->setParameterValue(kParamChorus, 0.5f);
+    plugin->setParameterValue(kParamReverb, 0.5f);
+    plugin->activate();
+    return plugin;
+}
+
+// Minor faults while `plugin` renders its first kBlocks with a note held
+static long firstBlockFaults(Plugin5yn7h_& plugin, std::vector<float>& left, std::vector<float>& right) {
+    const MidiEvent on = noteOn(60);
+    const long before = minorFaults();
+    for (int b = 0; b < kBlocks; ++b) {
+        float* outputs[2] = { left.data() + b * kBlock, right.data() + b * kBlock };
+        plugin.run(nullptr, outputs, kBlock, &on, b == 0 ? 1 : 0);
+    }
+    return minorFaults() - before;
+}
+
+int main() {
+    prctl(PR_SET_THP_DISABLE, 1, 0, 0, 0);
+    // Written once up front, so the output pages don't count
+    std::vector<float> left(kBlocks * kBlock, 1.0f), right(kBlocks * kBlock, 1.0f);
+    for (double rate : kRates) {
+        for (int engine = 0; engine < kNumEngines; ++engine) {
+            std::unique_ptr<Plugin5yn7h_> warmUp = activated(std::unique_ptr<Plugin5yn7h_>(new Plugin5yn7h_()), rate, engine);
+            firstBlockFaults(*warmUp, left, right);
+            FreshPlugin plugin = activated(freshInstance(), rate, engine);
+            const long faults = firstBlockFaults(*plugin, left, right);
+            check(faults == 0, "%-18s %6.0f Hz: %ld minor faults in the first %d blocks",
+                  SynthEngines::name(engine), rate, faults, kBlocks);
+        }
+    }
+    std::printf("%d failed\n", failures());
+    return failures() == 0 ? 0 : 1;
+}
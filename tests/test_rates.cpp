@@ -0,0 +1,134 @@
+// test_rates.cpp - Pitch and effect times hold at every supported host rate
+// Each engine plays A4 at 44.1, 48, 88.2, 96 and 192 kHz. Its pitch, the
+// strongest spectral peak within a semitone of 440 Hz, must match the 48 kHz
+// render, and sit on 440 Hz for the engines tuned exactly. The delay, chorus
+// and reverb must put their first output the same time after the dry signal.
+#include "headless.hpp"
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include "engines/fft.h"
+
+static const double kRates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+
+struct PitchCase {
+    double tolerance; // cents from the 48 kHz render
+    float morph;      // negative: the default
+    bool onA4;        // tuned exactly: within a cent of 440 Hz
+};
+
+// In registry order
+static const PitchCase kPitchCases[] = {
+    { 1.0, -1.0f, true },  // Sine
+    { 1.0, -1.0f, true },  // Triangle
+    { 1.0, -1.0f, true },  // Square
+    { 1.0, -1.0f, true },  // Saw
+    { 1.0, -1.0f, false }, // SuperSaw: the loudest detuned saw wins
+    { 1.0, -1.0f, true },  // Virtual Analog
+    { 1.0, -1.0f, true },  // FM
+    { 1.0, -1.0f, true },  // Formant
+    { 1.0, -1.0f, false }, // Additive
+    { 1.0, -1.0f, true },  // Chord
+    // String/Resonator rounds its loop to whole samples, so its tuning error
+    // shrinks as the rate rises; a rate bug is a semitone or more
+    { 35.0, -1.0f, false },
+    { 1.0, -1.0f, true },  // PWM
+    { 5.0, 0.9f, false },  // Modal, struck: bowed, the modes ring on noise
+    { 1.0, -1.0f, true },  // Wavefolder
+    { 1.0, -1.0f, false }, // Granular: grains are detuned by the spray
+    { 1.0, -1.0f, true },  // String Bank
+};
+static_assert(sizeof(kPitchCases) / sizeof(kPitchCases[0]) == kNumEngines, "one case per engine");
+
+// Strongest peak between 415 and 466 Hz of 0.32 s from 0.2 s on: Hann window,
+// 4x zero padding, parabolic interpolation on the log magnitude. The window
+// has the same length in seconds at every rate, so beating between detuned
+// voices weighs the same.
+static double pitch(const std::vector<float>& x, double rate) {
+    const size_t from = size_t(0.2 * rate), length = size_t(0.32 * rate);
+    size_t size = 1;
+    while (size < 4 * length) size *= 2;
+    std::vector<std::complex<double>> bins(size);
+    for (size_t i = 0; i < length; ++i)
+        bins[i] = x[from + i] * (0.5 - 0.5 * std::cos(2.0 * M_PI * double(i) / double(length)));
+    Fft<double>(size).forward(bins.data());
+    const size_t lo = size_t(415.3 * double(size) / rate), hi = size_t(466.2 * double(size) / rate);
+    size_t best = lo;
+    for (size_t k = lo; k <= hi; ++k)
+        if (std::abs(bins[k]) > std::abs(bins[best])) best = k;
+    const double a = std::log(std::abs(bins[best - 1])), b = std::log(std::abs(bins[best])),
+                 c = std::log(std::abs(bins[best + 1]));
+    return (double(best) + 0.5 * (a - c) / (a - 2.0 * b + c)) * rate / double(size);
+}
+
+static double cents(double f, double reference) { return 1200.0 * std::log2(f / reference); }
+
+static void testPitch() {
+    for (int engine = 0; engine < kNumEngines; ++engine) {
+        const PitchCase& test = kPitchCases[engine];
+        double found[5];
+        for (int r = 0; r < 5; ++r) {
+            std::srand(1); // engines that draw from rand() start alike
+            std::unique_ptr<Plugin5yn7h_> plugin = makePlugin(kRates[r]);
+            plugin->setParameterValue(kParamModel, float(engine));
+            plugin->setParameterValue(kParamMod1Amount, 0.0f); // no tremolo
+            if (test.morph >= 0.0f) plugin->setParameterValue(kParamMorph, test.morph);
+            plugin->activate();
+            found[r] = pitch(renderNote(*plugin, 69, size_t(0.6 * kRates[r])), kRates[r]);
+        }
+        for (int r = 0; r < 5; ++r) {
+            const double offset = cents(found[r], found[1]);
+            check(std::fabs(offset) <= test.tolerance, "%-18s %6.0f Hz: %8.3f Hz, %+6.2f cents from 48 kHz",
+                  SynthEngines::name(engine), kRates[r], found[r], offset);
+            if (test.onA4)
+                check(std::fabs(cents(found[r], 440.0)) <= 1.0, "%-18s %6.0f Hz: in tune",
+                      SynthEngines::name(engine), kRates[r]);
+        }
+    }
+}
+
+// Seconds from the note-on to the first non-zero output sample, on the Sine
+// engine with `effect` (if any) fully wet
+static double firstOutput(double rate, int effect) {
+    std::unique_ptr<Plugin5yn7h_> plugin = makePlugin(rate);
+    plugin->setParameterValue(kParamModel, 0.0f);
+    if (effect >= 0) plugin->setParameterValue(uint32_t(effect), 1.0f);
+    plugin->setParameterValue(kParamDelayFeedback, 0.0f);
+    plugin->activate();
+    const std::vector<float> out = renderNote(*plugin, 69, size_t(0.5 * rate));
+    size_t first = 0;
+    while (first < out.size() && out[first] == 0.0f) ++first;
+    return double(first) / rate;
+}
+
+static void testEffectTimes() {
+    struct Effect {
+        const char* name;
+        int param;
+        double expected; // seconds after the dry signal; negative: as at 48 kHz
+    };
+    const Effect effects[] = {
+        { "delay", kParamDelay, 0.375 },            // the default Delay Time
+        { "reverb", kParamReverb, 1116 / 48000.0 }, // the shortest comb
+        { "chorus", kParamChorus, -1.0 },           // the shortest voice delay
+    };
+    double dry[5];
+    for (int r = 0; r < 5; ++r) dry[r] = firstOutput(kRates[r], -1);
+    for (const Effect& effect : effects) {
+        double reference = effect.expected;
+        if (reference < 0.0) reference = firstOutput(48000.0, effect.param) - dry[1];
+        for (int r = 0; r < 5; ++r) {
+            const double t = firstOutput(kRates[r], effect.param) - dry[r];
+            // Lines are whole samples long, the 48 kHz reference's included
+            check(std::fabs(t - reference) <= 2.0 / 44100.0, "%-6s %6.0f Hz: %8.3f ms after the dry signal (%8.3f ms)",
+                  effect.name, kRates[r], 1000.0 * t, 1000.0 * reference);
+        }
+    }
+}
+
+int main() {
+    testPitch();
+    testEffectTimes();
+    std::printf("%d failed\n", failures());
+    return failures() == 0 ? 0 : 1;
+}
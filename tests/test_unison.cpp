@@ -0,0 +1,77 @@
+// test_unison.cpp - A unison stack is as loud as a single voice
+// Each engine plays middle C alone and as a full stack of its unison copies.
+// At Detune 0, copies of an engine that starts alike play in phase, so their
+// sum must match the single voice, also when the copies join mid-note. Copies
+// of an engine with a random start (kRandomStart) add up in power instead;
+// their level is a draw, so it is averaged over kDraws stacks. Fully detuned,
+// every stack adds up in power and stays near the single voice.
+#include "headless.hpp"
+#include <cmath>
+
+static constexpr float kRate = 48000.0f;
+static constexpr float kFrequency = 261.63f;
+static constexpr size_t kFrames = size_t(1.5 * kRate);
+static constexpr int kDraws = 16;
+
+// Mean power in dB of the left and right output over 0.1 s to 1.5 s of `draws`
+// stacks. With `join`, the stack plays one voice for the first 0.1 s.
+template <typename E>
+static void level(int voices, float detune, bool join, int draws, double& left, double& right) {
+    double sumL = 0.0, sumR = 0.0;
+    const size_t from = size_t(0.1 * kRate);
+    for (int d = 0; d < draws; ++d) {
+        Stacked<E> stack;
+        std::vector<float> buffer(Stacked<E>::bufferSize(kRate));
+        stack.setBuffer(buffer.data(), kRate);
+        stack.setSampleRate(kRate);
+        stack.setFrequency(kFrequency);
+        stack.reset();
+        stack.setUnison(join ? 1 : voices, detune);
+        stack.trigger();
+        std::vector<float> l(kFrames), r(kFrames);
+        for (size_t pos = 0; pos < kFrames; pos += 64) {
+            if (pos == from) stack.setUnison(voices, detune);
+            stack.processBlock(l.data() + pos, r.data() + pos, 64);
+        }
+        for (size_t i = from; i < kFrames; ++i) {
+            sumL += double(l[i]) * l[i];
+            sumR += double(r[i]) * r[i];
+        }
+    }
+    left = 10.0 * std::log10(sumL / double(draws) / double(kFrames - from));
+    right = 10.0 * std::log10(sumR / double(draws) / double(kFrames - from));
+}
+
+template <typename E>
+static void compare() {
+    constexpr int kVoices = Stacked<E>::kVoices;
+    if (kVoices == 1) return;
+    const bool random = HasRandomStart<E>::value;
+    const int draws = random ? kDraws : 1;
+    // PWM's drift slowly pulls its copies apart. A random stack's level is
+    // set by a few strong partials, so the mean of kDraws still spreads by about 1 dB
+    const double tolerance = random ? 1.5 : 0.25;
+    double singleL, singleR, stackL, stackR, joinL, joinR, detunedL, detunedR;
+    level<E>(1, 0.0f, false, draws, singleL, singleR);
+    level<E>(kVoices, 0.0f, false, draws, stackL, stackR);
+    level<E>(kVoices, 0.0f, true, draws, joinL, joinR);
+    level<E>(kVoices, 1.0f, false, draws, detunedL, detunedR);
+    check(std::fabs(stackL - singleL) <= tolerance && std::fabs(stackR - singleR) <= tolerance,
+          "%-16s %d voices at Detune 0: %+.2f / %+.2f dB against one voice", E::kName, kVoices, stackL - singleL,
+          stackR - singleR);
+    check(std::fabs(joinL - singleL) <= tolerance && std::fabs(joinR - singleR) <= tolerance,
+          "%-16s joining mid-note at Detune 0: %+.2f / %+.2f dB", E::kName, joinL - singleL, joinR - singleR);
+    check(std::fabs(detunedL - singleL) <= 2.0 && std::fabs(detunedR - singleR) <= 2.0,
+          "%-16s at Detune 1: %+.2f / %+.2f dB", E::kName, detunedL - singleL, detunedR - singleR);
+}
+
+template <typename... Engines>
+static void compareAll(EngineList<Engines...>) { (compare<Engines>(), ...); }
+
+int main() {
+    compareAll(EngineList<SineEngine, TriangleEngine, SquareEngine, SawEngine, SuperSawEngine,
+                          FaithfulVirtualAnalogEngine, FMEngine, FormantEngine, AdditiveEngine, ChordEngine,
+                          StringEngine, PWMEngine, ModalEngine, WavefolderEngine, GranularEngine, StringBankEngine>());
+    std::printf("%d failed\n", failures());
+    return failures() == 0 ? 0 : 1;
+}